@@ -23,6 +23,11 @@
 #include <algorithm>
 #endif
 
+#ifndef VECTOR_H
+#define VECTOR_H
+#include <vector>
+#endif
+
 #ifndef FILESYSTEM_H
 #define FILESYSTEM_H
 #include <filesystem>
@@ -63,6 +68,13 @@ public:
    */
   void new_word();
 
+  /**
+   * @brief Start a new game with a given word.
+   *
+   * @param word Target word (length 5, all lowercase)
+   */
+  void set_target_word(const std::string &word);
+
   /**
    * @brief Make a guess
    *
@@ -78,6 +90,14 @@ public:
    */
   std::string get_target_word();
 
+  /**
+   * @brief Read every possible target word
+   *
+   * @param data_path Path to data dir containing test_words.txt
+   * @return std::vector<std::string> Targets in file order
+   */
+  static std::vector<std::string> load_target_words(const std::string &data_path);
+
 private:
   fs::path word_file_path;
   int num_words;
@@ -0,0 +1,180 @@
+#ifndef STDINT_H
+#define STDINT_H
+#include <stdint.h>
+#endif
+
+#ifndef STRING_H
+#define STRING_H
+#include <string>
+#endif
+
+#ifndef VECTOR_H
+#define VECTOR_H
+#include <vector>
+#endif
+
+#ifndef CSTRING_H
+#define CSTRING_H
+#include <cstring>
+#endif
+
+#ifndef STDEXCEPT_H
+#define STDEXCEPT_H
+#include <stdexcept>
+#endif
+
+#ifndef TYPE_TRAITS_H
+#define TYPE_TRAITS_H
+#include <type_traits>
+#endif
+
+/**
+ * @brief Saved progress of a long job so a killed run can resume
+ *
+ * The file is a header followed by a payload of plain values and arrays
+ * that the job writes and reads back in the same order. The header holds
+ * the job kind and a key hashed from the job's inputs, so a checkpoint is
+ * only resumed by the job that wrote it, and a payload checksum. Saves go to a temporary file that
+ * is renamed over the old one, so a kill mid save leaves the last good
+ * checkpoint in place.
+ */
+class Checkpoint
+{
+public:
+  struct Header
+  {
+    char magic[4];
+    uint32_t version;
+    uint32_t kind;
+    // low 32 bits of the payload's FNV-1a hash
+    uint32_t checksum;
+    uint64_t key;
+    uint64_t payload_size;
+  };
+
+  /**
+   * @brief Construct a new Checkpoint object
+   *
+   * @param path File to save to and resume from
+   * @param kind Job kind, such as the mode letter
+   * @param key Hash of everything the job's results depend on
+   */
+  Checkpoint(const std::string &path, const uint32_t kind, const uint64_t key);
+
+  /**
+   * @brief Read a saved checkpoint into the payload. Throws if the file is
+   * damaged or was written by a different job.
+   *
+   * @return true A checkpoint for this job was read and can be resumed
+   * @return false There is no saved checkpoint
+   */
+  bool load();
+
+  /**
+   * @brief Check whether the payload holds a checkpoint read by load() that
+   * has not been set aside, so a job can resume without reading the file again
+   *
+   * @return true The payload can be read back with get
+   * @return false The job starts fresh
+   */
+  bool is_loaded() const;
+
+  /**
+   * @brief Get the file the checkpoint is saved to
+   *
+   * @return const std::string& Path given to the constructor
+   */
+  const std::string &get_path() const;
+
+  /**
+   * @brief Write the payload, replacing the saved checkpoint atomically
+   *
+   */
+  void save();
+
+  /**
+   * @brief Delete the saved checkpoint once the job is done
+   *
+   */
+  void remove();
+
+  /**
+   * @brief Move a checkpoint that cannot be resumed to the same path with
+   * .bad appended, so the job starts fresh without losing the file
+   *
+   */
+  void set_aside();
+
+  /**
+   * @brief Empty the payload before writing a new checkpoint
+   *
+   */
+  void clear();
+
+  template <typename T>
+  void put(const T &value);
+
+  template <typename T>
+  void put(const std::vector<T> &values);
+
+  template <typename T>
+  void get(T &value);
+
+  template <typename T>
+  void get(std::vector<T> &values);
+
+  /**
+   * @brief Hash file contents and extra values into a checkpoint key
+   *
+   * @param paths Input files of the job
+   * @param salt Anything else the results depend on
+   * @return uint64_t 64 bit FNV-1a hash
+   */
+  static uint64_t make_key(const std::vector<std::string> &paths, const uint64_t salt);
+
+private:
+  void read(void *dst, const size_t n);
+
+  std::string path;
+  uint32_t kind;
+  uint64_t key;
+  std::vector<char> payload;
+  size_t read_pos;
+  bool loaded;
+};
+
+template <typename T>
+void Checkpoint::put(const T &value)
+{
+  static_assert(std::is_trivially_copyable<T>::value, "checkpoint values must be plain data");
+  const char *p = reinterpret_cast<const char *>(&value);
+  payload.insert(payload.end(), p, p + sizeof(T));
+}
+
+template <typename T>
+void Checkpoint::put(const std::vector<T> &values)
+{
+  static_assert(std::is_trivially_copyable<T>::value, "checkpoint values must be plain data");
+  put<uint64_t>(values.size());
+  const char *p = reinterpret_cast<const char *>(values.data());
+  payload.insert(payload.end(), p, p + values.size() * sizeof(T));
+}
+
+template <typename T>
+void Checkpoint::get(T &value)
+{
+  static_assert(std::is_trivially_copyable<T>::value, "checkpoint values must be plain data");
+  read(&value, sizeof(T));
+}
+
+template <typename T>
+void Checkpoint::get(std::vector<T> &values)
+{
+  static_assert(std::is_trivially_copyable<T>::value, "checkpoint values must be plain data");
+  uint64_t size;
+  get(size);
+  if (size > (payload.size() - read_pos) / sizeof(T))
+    throw std::runtime_error("truncated checkpoint " + path);
+  values.resize(size);
+  read(values.data(), size * sizeof(T));
+}
@@ -0,0 +1,155 @@
+#ifndef STRING_H
+#define STRING_H
+#include <string>
+#endif
+
+#ifndef VECTOR_H
+#define VECTOR_H
+#include <vector>
+#endif
+
+#ifndef DEQUE_H
+#define DEQUE_H
+#include <deque>
+#endif
+
+#ifndef STDEXCEPT_H
+#define STDEXCEPT_H
+#include <stdexcept>
+#endif
+
+#ifndef UNISTD_H
+#define UNISTD_H
+#include <unistd.h>
+#endif
+
+#ifndef SYS_TYPES_H
+#define SYS_TYPES_H
+#include <sys/types.h>
+#endif
+
+#ifndef ADVERSARY_HPP
+#define ADVERSARY_HPP
+#include "Adversary.hpp"
+#endif
+
+#ifndef SOLVER_HPP
+#define SOLVER_HPP
+#include "Solver.hpp"
+#endif
+
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+#include "Checkpoint.hpp"
+#endif
+
+/**
+ * @brief Runs a full answer sweep across local worker processes
+ *
+ * Workers are forked from the coordinator after the opening guess is
+ * cached, so each one starts warm. Tasks and results travel over a Unix
+ * socket per worker as fixed size records, which is all a worker on
+ * another node would need. Targets held by a worker that dies are handed
+ * to a replacement. With a checkpoint, finished targets and the opening
+ * guess are saved every CHECKPOINT_INTERVAL_MS and a restarted sweep only
+ * plays the rest.
+ */
+class Coordinator
+{
+public:
+  /**
+   * @brief Construct a new Coordinator object
+   *
+   * @param data_path Path to data dir containing word_weights.txt and test_words.txt
+   * @param num_workers Number of worker processes to keep running
+   * @param checkpoint Where to save progress, resumed from if already loaded, or nullptr
+   */
+  Coordinator(const std::string &data_path, const int num_workers, Checkpoint *checkpoint = nullptr);
+
+  /**
+   * @brief Stop all workers and destroy the Coordinator object
+   *
+   */
+  ~Coordinator();
+
+  Coordinator(const Coordinator &) = delete;
+  Coordinator &operator=(const Coordinator &) = delete;
+
+  /**
+   * @brief Solve every target word
+   *
+   * @return std::vector<int> Guess count for each target, in test_words.txt order
+   */
+  std::vector<int> sweep();
+
+  /**
+   * @brief Get the number of targets restored from the checkpoint
+   *
+   * @return size_t Targets that were already solved when the sweep started
+   */
+  size_t get_resumed_count();
+
+  /**
+   * @brief Get the target words
+   *
+   * @return const std::vector<std::string>& Targets in test_words.txt order
+   */
+  const std::vector<std::string> &get_targets();
+
+  /**
+   * @brief Get the number of workers that were replaced after dying
+   *
+   * @return int Respawn count
+   */
+  int get_respawn_count();
+
+  /**
+   * @brief Play one game to the end
+   *
+   * @param solver Solver to play with, reset afterwards
+   * @param adversary Adversary holding the target word
+   * @return int Number of guesses used
+   */
+  template <typename T>
+  static int play_target(T &solver, Adversary &adversary);
+
+private:
+  struct Worker
+  {
+    pid_t pid;
+    int fd;
+    std::deque<int> in_flight;
+  };
+
+  void spawn(const size_t i);
+  void reap(const size_t i, std::deque<int> &pending);
+  void worker_loop(const int fd);
+  void save_checkpoint();
+
+  Solver solver;
+  Adversary adversary;
+  std::vector<std::string> targets;
+  std::vector<Worker> workers;
+  int respawn_count;
+  Checkpoint *checkpoint;
+  std::vector<int> results;
+  size_t resumed_count;
+};
+
+template <typename T>
+int Coordinator::play_target(T &solver, Adversary &adversary)
+{
+  char word[5], res[5];
+  int num_guesses = 1;
+  solver.make_guess(word);
+  adversary.judge(word, res);
+  while (std::count(std::begin(res), std::end(res), 'G') < 5)
+  {
+    if (++num_guesses > MAX_GUESSES)
+      throw std::runtime_error("no solution for " + adversary.get_target_word());
+    solver.make_guess(word, res);
+    adversary.judge(word, res);
+  }
+  solver.reset();
+  return num_guesses;
+}
@@ -0,0 +1,98 @@
+#ifndef STRING_H
+#define STRING_H
+#include <string>
+#endif
+
+#ifndef VECTOR_H
+#define VECTOR_H
+#include <vector>
+#endif
+
+#ifndef ATOMIC_H
+#define ATOMIC_H
+#include <atomic>
+#endif
+
+#ifndef ADVERSARY_HPP
+#define ADVERSARY_HPP
+#include "Adversary.hpp"
+#endif
+
+#ifndef SOLVER_HPP
+#define SOLVER_HPP
+#include "Solver.hpp"
+#endif
+
+/**
+ * @brief Scores the solver policy over every target in one walk of its
+ * decision tree
+ *
+ * Replaying games one at a time recomputes the guesses every game shares.
+ * The walk instead splits the targets at each node by the result they
+ * give, and asks the solver for one guess per distinct node, branching the
+ * game with snapshots. Subtrees below the opening are handed out to
+ * threads, largest first, and each thread has its own solver.
+ */
+class Evaluator
+{
+public:
+  /**
+   * @brief Construct a new Evaluator object
+   *
+   * @param data_path Path to data dir containing word_weights.txt and test_words.txt
+   * @param num_threads Threads walking subtrees
+   */
+  Evaluator(const std::string &data_path, const int num_threads);
+
+  /**
+   * @brief Change the weight of a word in every thread's solver
+   *
+   * @param word A word in the dictionary
+   * @param weight Prior weight, above 0
+   */
+  void set_word_weight(const std::string &word, const double weight);
+
+  /**
+   * @brief Score guesses from a pattern row cache shared by every thread
+   *
+   * @param cache Cache to read and fill
+   */
+  void enable_pattern_cache(const std::shared_ptr<PatternCache> &cache);
+
+  /**
+   * @brief Walk the decision tree over all targets
+   *
+   * @return std::vector<int> Guess count for each target, in test_words.txt order
+   */
+  std::vector<int> evaluate();
+
+  /**
+   * @brief Get the target words
+   *
+   * @return const std::vector<std::string>& Targets in test_words.txt order
+   */
+  const std::vector<std::string> &get_targets();
+
+  /**
+   * @brief Get the number of guesses the solver made in the last walk
+   *
+   * @return size_t One per node of the decision tree
+   */
+  size_t get_node_count();
+
+private:
+  struct Branch
+  {
+    char result[5];
+    std::vector<int> targets;
+  };
+
+  void split(Adversary &adversary, const char (&guess)[5], const std::vector<int> &targets, const int depth, std::vector<Branch> &branches);
+  void walk(Solver &solver, Adversary &adversary, const char (&guess)[5], const std::vector<int> &targets, const int depth);
+
+  std::vector<Solver> solvers;
+  std::vector<Adversary> adversaries;
+  std::vector<std::string> targets;
+  std::vector<int> results;
+  std::atomic<size_t> node_count;
+};
@@ -0,0 +1,119 @@
+#ifndef STDINT_H
+#define STDINT_H
+#include <stdint.h>
+#endif
+
+#ifndef STRING_H
+#define STRING_H
+#include <string>
+#endif
+
+#ifndef VECTOR_H
+#define VECTOR_H
+#include <vector>
+#endif
+
+#ifndef UNORDERED_MAP_H
+#define UNORDERED_MAP_H
+#include <unordered_map>
+#endif
+
+#ifndef SOLVER_HPP
+#define SOLVER_HPP
+#include "Solver.hpp"
+#endif
+
+/**
+ * @brief Ranked suggestions for the first moves of a game, looked up by
+ * the moves played so far instead of scored
+ *
+ * A history is the guesses and results played, as "tares BYBBG crane
+ * GGBBB", and the empty history is the opening. compile follows the
+ * solver's own suggestion at every move, so a book of depth 2 holds the
+ * opening and the reply to each of its results. Entries can also be added
+ * at run time, so the book doubles as a cache of states already scored.
+ * The file is text:
+ *
+ *   # comment lines
+ *   <hash of word_weights.txt>
+ *   <history> | <word> <score> <buckets> <largest bucket> <entropy> ...
+ */
+class OpeningBook
+{
+public:
+  /**
+   * @brief Construct an empty Opening Book object
+   *
+   */
+  OpeningBook();
+
+  /**
+   * @brief Load a compiled book. Throws if the file is malformed.
+   *
+   * @param book_path Path to a file written by compile
+   */
+  OpeningBook(const std::string &book_path);
+
+  /**
+   * @brief Play the solver's suggestions from the opening and write the ranking of every state reached
+   *
+   * @param data_path Path to data dir containing word_weights.txt
+   * @param book_path Where to write the book, replaced atomically
+   * @param depth Moves to cover, at least 1
+   * @param k Ranked guesses kept per state
+   * @return size_t Number of states written
+   */
+  static size_t compile(const std::string &data_path, const std::string &book_path, const int depth, const size_t k);
+
+  /**
+   * @brief Hash the word list a book is only valid for
+   *
+   * @param data_path Path to data dir containing word_weights.txt
+   * @return uint64_t Key to compare with get_key
+   */
+  static uint64_t make_key(const std::string &data_path);
+
+  /**
+   * @brief Append a move to a history
+   *
+   * @param history Moves so far
+   * @param guess 5 letter guess
+   * @param result 5 of G, Y, B
+   * @return std::string The longer history
+   */
+  static std::string extend(const std::string &history, const std::string &guess, const std::string &result);
+
+  /**
+   * @brief Find the ranking of a state
+   *
+   * @param history Moves so far
+   * @return const std::vector<Solver::RankedGuess>* Best first, or nullptr if the state is not in the book
+   */
+  const std::vector<Solver::RankedGuess> *find(const std::string &history) const;
+
+  /**
+   * @brief Add or replace the ranking of a state
+   *
+   * @param history Moves so far
+   * @param ranking Best first, not empty
+   */
+  void insert(const std::string &history, const std::vector<Solver::RankedGuess> &ranking);
+
+  /**
+   * @brief Get the hash of the word list the book was compiled from
+   *
+   * @return uint64_t 0 for a book that was not loaded from a file
+   */
+  uint64_t get_key() const;
+
+  /**
+   * @brief Get the number of states in the book
+   *
+   * @return size_t
+   */
+  size_t get_entry_count() const;
+
+private:
+  uint64_t key;
+  std::unordered_map<std::string, std::vector<Solver::RankedGuess>> entries;
+};
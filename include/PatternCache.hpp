@@ -0,0 +1,127 @@
+#ifndef STDINT_H
+#define STDINT_H
+#include <stdint.h>
+#endif
+
+#ifndef VECTOR_H
+#define VECTOR_H
+#include <vector>
+#endif
+
+#ifndef LIST_H
+#define LIST_H
+#include <list>
+#endif
+
+#ifndef UNORDERED_MAP_H
+#define UNORDERED_MAP_H
+#include <unordered_map>
+#endif
+
+#ifndef MUTEX_H
+#define MUTEX_H
+#include <mutex>
+#endif
+
+/**
+ * @brief Bounded LRU cache of compressed pattern rows
+ *
+ * A row holds the result index of one guess against every word in the
+ * dictionary. Rows are packed as 4 bit codes into a per-row table of the
+ * 15 most common results, with an escape code followed by a literal byte
+ * for the rest. Literals are indexed per block of codes, so single entries
+ * can be read without decoding the whole row. Safe to share between threads.
+ */
+class PatternCache
+{
+public:
+  /**
+   * @brief Construct a new Pattern Cache object
+   *
+   * @param budget_bytes Most memory the stored rows may use
+   */
+  PatternCache(const size_t budget_bytes);
+
+  /**
+   * @brief Look up a row and decode it
+   *
+   * @param guess Dictionary index of the guess
+   * @param row Filled with one result index per dictionary word on a hit
+   * @return true if the row was cached
+   */
+  bool lookup(const int guess, std::vector<uint8_t> &row);
+
+  /**
+   * @brief Look up a row and read only some of its entries, for states
+   * where few dictionary words are left
+   *
+   * @param guess Dictionary index of the guess
+   * @param ids Dictionary indices of the entries to read
+   * @param count Number of ids
+   * @param out Filled with the result index of each id on a hit
+   * @return true if the row was cached and covers every id
+   */
+  bool lookup(const int guess, const int *ids, const size_t count, uint8_t *out);
+
+  /**
+   * @brief Compress and store a row, evicting least recently used rows
+   *
+   * @param guess Dictionary index of the guess
+   * @param row One result index per dictionary word
+   */
+  void insert(const int guess, const std::vector<uint8_t> &row);
+
+  /**
+   * @brief Set one entry of a cached row, so rows can follow dictionary
+   * changes without being rebuilt. Rows that are not cached are skipped.
+   *
+   * @param guess Dictionary index of the guess
+   * @param index Dictionary index of the word, at most the row length
+   * @param result Result index the guess gets against the word
+   */
+  void patch(const int guess, const size_t index, const uint8_t result);
+
+  /**
+   * @brief Get the guesses whose rows are cached
+   *
+   * @return std::vector<int> Dictionary indices, most recently used first
+   */
+  std::vector<int> get_guesses();
+
+  /**
+   * @brief Drop every row
+   *
+   */
+  void clear();
+
+  /**
+   * @brief Get the fraction of lookups that hit
+   *
+   * @return double 0 ≤ hit rate ≤ 1
+   */
+  double get_hit_rate();
+
+  long long get_hits();
+  long long get_misses();
+  long long get_evictions();
+  size_t get_bytes_used();
+  size_t get_row_count();
+
+private:
+  struct Entry
+  {
+    std::list<int>::iterator order;
+    std::vector<uint8_t> blob;
+  };
+
+  static void encode(const std::vector<uint8_t> &row, std::vector<uint8_t> &blob);
+  static void decode(const std::vector<uint8_t> &blob, std::vector<uint8_t> &row);
+  void evict();
+
+  size_t budget;
+  size_t used;
+  long long hits, misses, evictions;
+  std::list<int> order;
+  std::unordered_map<int, Entry> rows;
+  std::mutex mutex;
+};
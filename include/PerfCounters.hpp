@@ -0,0 +1,96 @@
+#ifndef STDINT_H
+#define STDINT_H
+#include <stdint.h>
+#endif
+
+#ifndef STRING_H
+#define STRING_H
+#include <string>
+#endif
+
+#ifndef VECTOR_H
+#define VECTOR_H
+#include <vector>
+#endif
+
+/**
+ * @brief Hardware event counters of this process, from perf_event_open
+ *
+ * Each event is opened on its own and counts user space only, so it works
+ * at the default perf_event_paranoid level. Events the kernel or CPU does
+ * not offer (virtual machines often have no PMU at all) are marked
+ * unavailable rather than failing, and read back as -1. Counts are scaled
+ * up when the kernel had to multiplex counters.
+ */
+class PerfCounters
+{
+public:
+  struct Event
+  {
+    std::string name;
+    // perf_event_attr type and config
+    uint32_t type;
+    uint64_t config;
+  };
+
+  /**
+   * @brief Open and start the counters
+   *
+   * @param events Events to count
+   * @param inherit Also count threads started after this, which are added
+   * in as they exit
+   */
+  PerfCounters(const std::vector<Event> &events, const bool inherit);
+
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  /**
+   * @brief Close the counters and destroy the Perf Counters object
+   *
+   */
+  ~PerfCounters();
+
+  /**
+   * @brief Get the events that show how well memory placement works: data
+   * TLB misses and loads that missed the local NUMA node
+   *
+   * @return std::vector<Event>
+   */
+  static std::vector<Event> placement_events();
+
+  /**
+   * @brief Get the events that show what limits a kernel: CPU time, cycles,
+   * instructions, branch misses, L1 data and last level cache load misses,
+   * and cycles stalled in the front and back end
+   *
+   * @return std::vector<Event>
+   */
+  static std::vector<Event> profile_events();
+
+  /**
+   * @brief Get the events being counted
+   *
+   * @return const std::vector<Event>& In the order they were given
+   */
+  const std::vector<Event> &get_events();
+
+  /**
+   * @brief Get the number of events the kernel opened
+   *
+   * @return size_t 0 when counters are not available at all
+   */
+  size_t get_available_count();
+
+  /**
+   * @brief Read every counter
+   *
+   * @param values Count of each event since the counters were opened, or -1
+   * if it is not available. Resized to the event count.
+   */
+  void read(std::vector<long long> &values);
+
+private:
+  std::vector<Event> events;
+  std::vector<int> fds;
+};
@@ -0,0 +1,135 @@
+#ifndef STRING_H
+#define STRING_H
+#include <string>
+#endif
+
+#ifndef VECTOR_H
+#define VECTOR_H
+#include <vector>
+#endif
+
+#ifndef ATOMIC_H
+#define ATOMIC_H
+#include <atomic>
+#endif
+
+#ifndef THREAD_H
+#define THREAD_H
+#include <thread>
+#endif
+
+#ifndef MUTEX_H
+#define MUTEX_H
+#include <mutex>
+#endif
+
+#ifndef CONDITION_VARIABLE_H
+#define CONDITION_VARIABLE_H
+#include <condition_variable>
+#endif
+
+#ifndef WORD_SHARDS_HPP
+#define WORD_SHARDS_HPP
+#include "WordShards.hpp"
+#endif
+
+/**
+ * @brief Wordle solver for dictionaries too large to hold as Word objects
+ *
+ * Candidates are a bitmap over the mapped shards, so memory stays at one
+ * bit per word plus the histograms of one block of guesses per thread.
+ * A pool of as many threads as there are cores, started once, takes
+ * blocks of guesses in turn and
+ * score each against every shard in dictionary order, so scores and ties
+ * are the same as Solver's with any thread count, except that states with
+ * more than guess_limit candidates only consider their guess_limit
+ * heaviest words as guesses.
+ */
+class ShardedSolver
+{
+public:
+  /**
+   * @brief Construct a new Sharded Solver object
+   *
+   * @param shards_path Path to shards written by WordShards::compile
+   * @param guess_limit Most guesses scored per move
+   */
+  ShardedSolver(const std::string &shards_path, const size_t guess_limit);
+
+  ShardedSolver(const ShardedSolver &) = delete;
+  ShardedSolver &operator=(const ShardedSolver &) = delete;
+
+  /**
+   * @brief Stop the pool and destroy the Sharded Solver object
+   *
+   */
+  ~ShardedSolver();
+
+  /**
+   * @brief Reset the solver for a new game
+   *
+   */
+  void reset();
+
+  /**
+   * @brief Make a guess
+   *
+   * @param guess Guess will be placed in here
+   */
+  void make_guess(char (&guess)[5]);
+
+  /**
+   * @brief Make a guess
+   *
+   * @param guess Guess will be placed in here
+   * @param result Result from previous guess. Throws, leaving the game as
+   * it was, if there is no previous guess, the result is malformed or no
+   * candidate fits.
+   */
+  void make_guess(char (&guess)[5], const char (&result)[5]);
+
+  /**
+   * @brief Get the entropy in the current game.
+   *
+   * @return double 0 ≤ entropy
+   */
+  double get_entropy();
+
+  /**
+   * @brief Get the number of possible words left
+   *
+   * @return size_t At least 1
+   */
+  size_t get_word_count();
+
+private:
+  void pick_guesses();
+  static void thread_start_routine(ShardedSolver *solver, const size_t thread);
+  void score_blocks(const size_t thread);
+
+  WordShards shards;
+  size_t guess_limit;
+  // one bit per dictionary word, set while it is a candidate
+  std::vector<uint64_t> live;
+  size_t count;
+  double total_weight;
+  // SUM -w log2 w over the candidates
+  double total_first;
+  std::vector<uint32_t> guesses;
+  // one block of guesses' histograms per thread
+  std::vector<std::vector<std::pair<double, double>>> thread_hist;
+  // each thread's best (score, dictionary index) in the current pass
+  std::vector<std::pair<double, uint32_t>> thread_best;
+  // workers 1 and up, the calling thread is worker 0
+  std::vector<std::thread> threads;
+  std::mutex pool_mutex;
+  std::condition_variable pool_cv, master_cv;
+  // bumped to start a pass, guarded by pool_mutex with pool_done and terminate_pool
+  uint64_t pool_generation;
+  size_t pool_done;
+  bool terminate_pool;
+  // first guess of the next block to hand out
+  std::atomic<size_t> next_block;
+  std::string prev_guess;
+  std::string opening_guess;
+};
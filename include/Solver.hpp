@@ -23,6 +23,11 @@
 #include <memory>
 #endif
 
+#ifndef UNORDERED_MAP_H
+#define UNORDERED_MAP_H
+#include <unordered_map>
+#endif
+
 #ifndef FSTREAM_H
 #define FSTREAM_H
 #include <fstream>
@@ -49,6 +54,21 @@ namespace fs = std::filesystem;
 #include <constants.hpp>
 #endif
 
+#ifndef PATTERN_CACHE_HPP
+#define PATTERN_CACHE_HPP
+#include "PatternCache.hpp"
+#endif
+
+#ifndef VALUE_TABLE_HPP
+#define VALUE_TABLE_HPP
+#include "ValueTable.hpp"
+#endif
+
+#ifndef TOPOLOGY_HPP
+#define TOPOLOGY_HPP
+#include "Topology.hpp"
+#endif
+
 #ifndef STRING_H
 #define STRING_H
 #include <string>
@@ -95,6 +115,26 @@ namespace fs = std::filesystem;
 #include <mutex>
 #endif
 
+#ifndef RANDOM_H
+#define RANDOM_H
+#include <random>
+#endif
+
+#ifndef UNISTD_H
+#define UNISTD_H
+#include <unistd.h>
+#endif
+
+#ifndef CONDITION_VARIABLE_H
+#define CONDITION_VARIABLE_H
+#include <condition_variable>
+#endif
+
+#ifndef ATOMIC_H
+#define ATOMIC_H
+#include <atomic>
+#endif
+
 #ifdef _DEBUG
 #define ASSERT(left, operator, right)                                                                                                                                                            \
   {                                                                                                                                                                                              \
@@ -117,6 +157,54 @@ namespace fs = std::filesystem;
 class Solver
 {
 public:
+  /**
+   * @brief Settings for approximate scoring of large states
+   *
+   */
+  struct ApproxConfig
+  {
+    // only states with at least this many candidates are approximated
+    size_t min_words;
+    // candidates drawn in the first round, doubled every round after
+    size_t initial_sample;
+    // guesses left when racing stops and exact scoring takes over
+    size_t finalists;
+    // width of the confidence interval in standard errors
+    double z;
+    unsigned int seed;
+  };
+
+  /**
+   * @brief One of the best guesses of a move, with how it splits the candidates
+   *
+   */
+  struct RankedGuess
+  {
+    std::string word;
+    // expected guesses to finish, as minimized by make_guess
+    double score;
+    // results that at least one candidate gives
+    int bucket_count;
+    // most candidates sharing one result
+    int largest_bucket;
+    // information from the result in bits, by candidate weight
+    double entropy;
+  };
+
+  /**
+   * @brief Candidates and last guess of a game in progress, for branching
+   * a game or taking back a move. Only valid for solvers built from the
+   * same word_weights.txt.
+   *
+   */
+  struct Snapshot
+  {
+    // dictionary index and weight of each candidate, in solver order
+    std::vector<int> ids;
+    std::vector<double> weights;
+    std::string prev_guess;
+  };
+
   /**
    * @brief Construct a new Solver object
    *
@@ -135,7 +223,7 @@ public:
    * @brief Destroy the Solver object
    *
    */
-  ~Solver() = default;
+  virtual ~Solver() = default;
 
   Solver &operator=(Solver &&rvalue) noexcept;
 
@@ -143,22 +231,59 @@ public:
    * @brief Reset the solver for a new game
    *
    */
-  void reset();
+  virtual void reset();
+
+  /**
+   * @brief Add a word, or bring back a removed one. It becomes a candidate
+   * from the next game, and cached pattern rows are patched to cover it.
+   *
+   * @param word 5 lowercase letters
+   * @param weight Prior weight, above 0
+   */
+  virtual void add_word(const std::string &word, const double weight);
+
+  /**
+   * @brief Remove a word from the dictionary and the current game
+   *
+   * @param word A word in the dictionary
+   */
+  virtual void remove_word(const std::string &word);
+
+  /**
+   * @brief Change the weight of a word, in the current game too
+   *
+   * @param word A word in the dictionary
+   * @param weight Prior weight, above 0
+   */
+  virtual void set_word_weight(const std::string &word, const double weight);
 
   /**
    * @brief Make a guess
    *
    * @param guess Guess will be placed in here
    */
-  void make_guess(char (&guess)[5]);
+  virtual void make_guess(char (&guess)[5]);
 
   /**
    * @brief Make a guess
    *
    * @param guess Guess will be placed in here
-   * @param result Result from previous guess
+   * @param result Result from previous guess. Throws, leaving the game as
+   * it was, if there is no previous guess, the result is malformed or no
+   * candidate fits.
    */
-  void make_guess(char (&guess)[5], const char (&result)[5]);
+  virtual void make_guess(char (&guess)[5], const char (&result)[5]);
+
+  /**
+   * @brief Narrow the candidates by the result of a guess the solver did
+   * not suggest, such as a player's own. make_guess(guess) then gives the
+   * next suggestion. Throws, leaving the game as it was, if the guess or
+   * result is malformed or no candidate fits.
+   *
+   * @param guess 5 lowercase letters, need not be in the dictionary
+   * @param result Result of the guess
+   */
+  virtual void apply_result(const std::string &guess, const char (&result)[5]);
 
   /**
    * @brief Get the entropy in the current game.
@@ -167,13 +292,172 @@ public:
    */
   double get_entropy();
 
+  /**
+   * @brief Get the number of possible words left
+   *
+   * @return int At least 1
+   */
+  int get_word_count();
+
+  /**
+   * @brief Get the cached opening guess
+   *
+   * @return std::string Empty until the first guess of a game has been made
+   */
+  std::string get_opening_guess();
+
+  /**
+   * @brief Restore an opening guess saved from an earlier run with the same word list
+   *
+   * @param guess 5 letter word from get_opening_guess
+   */
+  void set_opening_guess(const std::string &guess);
+
+  /**
+   * @brief Save the state of the current game
+   *
+   * @param snapshot Overwritten, reusing its memory
+   */
+  void save_snapshot(Snapshot &snapshot);
+
+  /**
+   * @brief Return to a saved state. The next guess is the one the solver
+   * would have made from there.
+   *
+   * @param snapshot From save_snapshot on this or an identical solver
+   */
+  virtual void restore_snapshot(const Snapshot &snapshot);
+
+  /**
+   * @brief Score each result bucket with a fitted value table instead of
+   * the linear entropy heuristic. Incremental histograms are not kept
+   * while a table is loaded, and approximate scoring still races on the
+   * linear heuristic.
+   *
+   * @param path Path to a table written by fit_values
+   */
+  virtual void load_value_table(const std::string &path);
+
+  /**
+   * @brief Keep the best guesses of each move, found in the same scan that
+   * picks the guess. Speculative results are not used while ranking.
+   *
+   * @param k Guesses to keep
+   */
+  void enable_ranking(const size_t k);
+
+  /**
+   * @brief Stop keeping the best guesses
+   *
+   */
+  void disable_ranking();
+
+  /**
+   * @brief Get the best guesses of the last move, best first
+   *
+   * @return const std::vector<RankedGuess>& Up to k guesses, empty if the
+   * move was scored approximately
+   */
+  const std::vector<RankedGuess> &get_ranking();
+
+  /**
+   * @brief Score guesses from cached pattern rows instead of comparing
+   * words, keeping the rows compressed under a memory budget.
+   *
+   * @param budget_bytes Most memory the cached rows may use
+   */
+  void enable_pattern_cache(const size_t budget_bytes);
+
+  /**
+   * @brief Score guesses from a pattern row cache shared with other solvers
+   * of the same dictionary. Rows do not depend on weights, so solvers with
+   * different weights can share one.
+   *
+   * @param cache Cache to read and fill
+   */
+  void enable_pattern_cache(const std::shared_ptr<PatternCache> &cache);
+
+  /**
+   * @brief Get the pattern row cache
+   *
+   * @return std::shared_ptr<PatternCache> nullptr if not enabled
+   */
+  std::shared_ptr<PatternCache> get_pattern_cache();
+
+  /**
+   * @brief Estimate scores from weighted samples of candidates in large
+   * states, racing guesses and dropping clearly worse ones each round, and
+   * only score the finalists exactly.
+   *
+   * @param config Sample sizes, finalist count and interval width
+   */
+  void enable_approx(const ApproxConfig &config);
+
+  /**
+   * @brief Score every guess exactly again
+   *
+   */
+  void disable_approx();
+
+  /**
+   * @brief Keep every guess's result histogram between moves and update it
+   * by subtracting removed words when that is cheaper than a rebuild
+   *
+   * @param budget_bytes Largest histogram table to keep (243 * 16 bytes per candidate)
+   */
+  void enable_incremental(const size_t budget_bytes);
+
+  /**
+   * @brief Stop carrying histograms between moves
+   *
+   */
+  void disable_incremental();
+
+  /**
+   * @brief Estimate the guesses still needed from the entropy of a bucket
+   *
+   * @param entropy Bits of entropy left
+   * @return double Expected number of guesses
+   */
+  static inline double heuristic(const double entropy);
+
+  /**
+   * @brief Check that a word could be the answer given a guess and its result
+   *
+   * @param word Candidate, 5 letters
+   * @param guessed Guess, 5 letters
+   * @param result Result of the guess, 5 codes
+   * @param code Codes for gray, yellow and green
+   * @return true if the word gives the guess that result
+   */
+  template <typename T, typename U, typename V>
+  static inline bool word_fits_result(const T &word, const U &guessed, const V &result, const char (&code)[3]);
+
+  /**
+   * @brief Get the result a guess gets against a word
+   *
+   * @param word Answer, 5 letters
+   * @param guessed Guess, 5 letters
+   * @return int Result index, base 3 with gray 0, yellow 1 and green 2
+   */
+  template <typename T, typename U>
+  static inline int word_to_result_index(const T &word, const U &guessed);
+
+  /**
+   * @brief Get the result index of a result written in G, Y and B
+   *
+   * @param result Result of a guess
+   * @return int Result index, as from word_to_result_index
+   */
+  static inline int result_to_index(const char (&result)[5]);
+
 protected:
   Solver() = default;
 
   class Word
   {
   public:
-    Word(const std::string &val, const double weight);
+    Word(const std::string &val, const double weight, const int id);
     Word(Word &&rvalue) noexcept;
     Word &operator=(Word &&rvalue) noexcept;
     char &operator[](unsigned int i);
@@ -181,21 +465,215 @@ protected:
 
     std::string val;
     double weight;
+    // index in the dictionary
+    int id;
   };
 
-  double calc_expect(const Word &guess);
-  static inline double heuristic(const double entropy);
-  template <typename T, typename U, typename V>
-  static inline bool word_fits_result(const T &word, const U &guessed, const V &result, const char (&code)[3]);
-  template <typename T, typename U>
-  static inline int word_to_result_index(const T &word, const U &guessed);
+  /**
+   * @brief Working memory for scoring, one per thread so moves do not allocate
+   *
+   */
+  struct Scratch
+  {
+    Scratch();
+    std::vector<std::pair<double, double>> results;
+    std::vector<int> counts;
+    std::vector<uint8_t> row;
+    // dictionary indices of the candidates, to read cached rows at
+    std::vector<int> ids;
+    // cached row entries of the candidates
+    std::vector<uint8_t> slice;
+    // approx_guess: cumulative weights, the round's sample and surviving
+    // guesses, and each survivor's estimate and score bounds
+    std::vector<double> cumulative;
+    std::vector<size_t> sample, alive, order, survivors;
+    std::vector<double> estimate;
+    std::vector<std::pair<double, double>> bounds;
+    // results of one guess against the sample
+    std::vector<uint8_t> patterns;
+    std::vector<std::pair<double, double>> block;
+    std::vector<int> block_counts;
+    // packed words to score from, when a node local copy replaces packed_vals and packed_weights
+    const char *vals;
+    const std::pair<double, double> *weights;
+  };
+
+  /**
+   * @brief Tile shape for score_block, sized from the detected cache sizes
+   *
+   */
+  struct Tiling
+  {
+    // guesses whose histograms stay in L2 while candidate tiles stream past
+    size_t guesses;
+    // candidates per tile, kept in L1 while a block of guesses is scored
+    size_t candidates;
+  };
+
+  static const Tiling &get_tiling();
+  size_t approx_guess();
+  virtual void approx_round();
+  void approx_range(const size_t first, const size_t last, Scratch &arena);
+  void set_guess(const std::string &val, char (&guess)[5]);
+  void pack_words();
+  void score_range(const size_t first, const size_t last, double *out, Scratch &arena);
+  void score_block(const size_t first, const size_t last, double *out, Scratch &arena);
+
+  int find_word(const std::string &word);
+  static void push_top(std::vector<std::pair<double, int>> &top, const size_t k, const double score, const int index);
+  void finish_ranking(Scratch &arena);
+  void check_result(const char (&result)[5]);
+  void filter_words(const char (&result)[5]);
+  void update_histograms(const size_t kept, const double min_weight);
+  virtual void subtract_removed(const double min_weight);
+  void subtract_range(const size_t first, const size_t last, const double min_weight);
+  double calc_expect(const Word &guess, Scratch &arena);
+  bool read_row(const Word &guess, Scratch &arena);
+  double sum_row(const Word &guess, Scratch &arena);
+  double calc_expect(const Word &guess, const std::vector<int> &subset, const double subset_weight, Scratch &arena);
+  double finish_expect(const std::pair<double, double> *results, const int *counts, const double guess_weight, const double weight);
 
   fs::path word_file_path;
   std::vector<Word> words;
+  // every word ever loaded or added, by index; removed words stay as tombstones
+  std::vector<std::string> dictionary;
+  std::vector<double> dictionary_weights;
+  std::vector<char> dictionary_live;
+  std::unordered_map<std::string, int> dictionary_index;
+  std::shared_ptr<PatternCache> pattern_cache;
+  Scratch scratch;
+  // words packed for score_block: 5 letters each, and (-w log2 w, w)
+  std::vector<char, HugePageAllocator<char>> packed_vals;
+  std::vector<std::pair<double, double>, HugePageAllocator<std::pair<double, double>>> packed_weights;
+  bool approx;
+  ApproxConfig approx_config;
+  std::mt19937_64 rng;
+  // per guess histograms in word order, kept across moves when incremental
+  size_t incremental_budget;
+  bool hist_keep, hist_valid;
+  std::vector<std::pair<double, double>, HugePageAllocator<std::pair<double, double>>> hist;
+  std::vector<char> keep_mask;
+  std::shared_ptr<const ValueTable> value_table;
+  // best (score, word index) of the current scan as a max heap, and the result
+  size_t ranking_k;
+  std::vector<std::pair<double, int>> top;
+  std::vector<RankedGuess> ranking;
+  std::vector<RankedGuess> opening_ranking;
   std::string prev_guess;
+  std::string opening_guess;
   double total_weight;
 };
 
+inline double Solver::heuristic(const double entropy)
+{
+  // a straight line between (0, 1) and (11.5, 3.5)
+  // simple regression on assumption that 11.5 bits of entropy requires about 3.5 guesses
+  return 0.217391304347826 * entropy + 1;
+}
+
+template <typename T, typename U, typename V>
+inline bool Solver::word_fits_result(const T &word, const U &guessed, const V &result, const char (&code)[3])
+{
+  bool used[5];
+  // 0=Gray, 1=Yellow, 2=Green
+  for (int i = 0; i < 5; i++)
+  {
+    if (result[i] == code[1] && guessed[i] == word[i])
+    {
+      return false;
+    }
+    else if (result[i] == code[2])
+    {
+      if (guessed[i] != word[i])
+        return false;
+      used[i] = true;
+    }
+    else
+    {
+      used[i] = false;
+    }
+  }
+  for (int i = 0; i < 5; i++)
+  {
+    if (result[i] == code[0])
+    {
+      for (int j = 0; j < 5; j++)
+      {
+        if (!used[j] && guessed[i] == word[j])
+          return false;
+      }
+    }
+    else if (result[i] == code[1])
+    {
+      bool flag = true;
+      for (int j = 0; j < 5; j++)
+      {
+        if (!used[j] && guessed[i] == word[j])
+        {
+          used[j] = true;
+          flag = false;
+          break;
+        }
+      }
+      if (flag)
+        return false;
+    }
+  }
+  return true;
+}
+
+template <typename T, typename U>
+inline int Solver::word_to_result_index(const T &word, const U &guessed)
+{
+  bool word_used[5], guess_used[5];
+  // 0=Gray, 1=Yellow, 2=Green
+  int result = 0;
+  for (int i = 0, radix = 1; i < 5; i++, radix *= 3)
+  {
+    if (guessed[i] == word[i])
+    {
+      result += 2 * radix;
+      word_used[i] = true;
+      guess_used[i] = true;
+    }
+    else
+    {
+      word_used[i] = false;
+      guess_used[i] = false;
+    }
+  }
+  for (int i = 0, radix = 1; i < 5; i++, radix *= 3)
+  {
+    if (!guess_used[i])
+    {
+      for (int j = 0; j < 5; j++)
+      {
+        if (!word_used[j] && guessed[i] == word[j])
+        {
+          result += radix;
+          word_used[j] = true;
+          break;
+        }
+      }
+    }
+  }
+  return result;
+}
+
+inline int Solver::result_to_index(const char (&result)[5])
+{
+  // same encoding as word_to_result_index
+  int index = 0;
+  for (int i = 0, radix = 1; i < 5; i++, radix *= 3)
+  {
+    if (result[i] == 'G')
+      index += 2 * radix;
+    else if (result[i] == 'Y')
+      index += radix;
+  }
+  return index;
+}
+
 /**
  * @brief Wordle solver bot with parallelization
  *
@@ -225,12 +703,57 @@ public:
    */
   ~SolverParallel();
 
+  /**
+   * @brief Return to a saved state, dropping speculative work
+   *
+   * @param snapshot From save_snapshot on this or an identical solver
+   */
+  void restore_snapshot(const Snapshot &snapshot) override;
+
+  /**
+   * @brief Add a word, or revive a removed one, dropping speculative work
+   *
+   * @param word 5 lowercase letters
+   * @param weight Prior weight, above 0
+   */
+  void add_word(const std::string &word, const double weight) override;
+
+  /**
+   * @brief Remove a word, dropping speculative work
+   *
+   * @param word A word in the dictionary
+   */
+  void remove_word(const std::string &word) override;
+
+  /**
+   * @brief Change the weight of a word, dropping speculative work
+   *
+   * @param word A word in the dictionary
+   * @param weight Prior weight, above 0
+   */
+  void set_word_weight(const std::string &word, const double weight) override;
+
+  /**
+   * @brief Narrow the candidates by the result of an outside guess, dropping speculative work
+   *
+   * @param guess 5 lowercase letters
+   * @param result Result of the guess
+   */
+  void apply_result(const std::string &guess, const char (&result)[5]) override;
+
+  /**
+   * @brief Score result buckets with a fitted table, dropping speculative work
+   *
+   * @param path Path to a table written by fit_values
+   */
+  void load_value_table(const std::string &path) override;
+
   /**
    * @brief Make a guess
    *
    * @param guess Guess will be placed in here
    */
-  void make_guess(char (&guess)[5]);
+  void make_guess(char (&guess)[5]) override;
 
   /**
    * @brief Make a guess
@@ -238,17 +761,122 @@ public:
    * @param guess Guess will be placed in here
    * @param result Result from previous guess
    */
-  void make_guess(char (&guess)[5], const char (&result)[5]);
+  void make_guess(char (&guess)[5], const char (&result)[5]) override;
+
+  /**
+   * @brief Reset the solver for a new game, dropping any speculative work
+   *
+   */
+  void reset() override;
+
+  /**
+   * @brief Precompute follow-up guesses while waiting for a result.
+   *
+   * After each guess, idle workers compute the best next guess for the
+   * heaviest result buckets first. A matching make_guess(guess, result)
+   * then returns without scoring.
+   *
+   * @param budget_bytes Cap on memory held by pending and finished buckets
+   */
+  void enable_speculation(const size_t budget_bytes);
+
+  /**
+   * @brief Stop speculating and drop all precomputed guesses
+   *
+   */
+  void disable_speculation();
+
+  /**
+   * @brief Stop in-flight speculative work and wait for workers to go idle
+   *
+   */
+  void cancel_speculation();
+
+  /**
+   * @brief Get the number of moves served from speculative results
+   *
+   * @return int Speculation hits since construction
+   */
+  int get_speculation_hits();
+
+  /**
+   * @brief Get the number of workers pinned to a CPU
+   *
+   * @return int Workers whose CPU affinity the kernel accepted
+   */
+  int get_pinned_count();
+
+  /**
+   * @brief Get the number of NUMA nodes that get their own copy of the packed words
+   *
+   * @return int 0 on single node hosts, which score from the solver's copy
+   */
+  int get_replica_count();
 
 private:
+  /**
+   * @brief Packed words copied into one NUMA node's memory by its first
+   * worker to score a move, so the other workers on the node read locally
+   *
+   */
+  struct NodeReplica
+  {
+    std::mutex mutex;
+    // pack_count when last copied
+    size_t version;
+    std::vector<char, HugePageAllocator<char>> vals;
+    std::vector<std::pair<double, double>, HugePageAllocator<std::pair<double, double>>> weights;
+  };
+
+  /**
+   * @brief Work the pool splits by guess, besides speculation
+   *
+   */
+  enum PoolTask
+  {
+    // score_range into thread_ret
+    POOL_SCORE,
+    // subtract_range with pool_min_weight
+    POOL_SUBTRACT,
+    // approx_range for one round of approx_guess
+    POOL_APPROX,
+  };
+
   static void thread_start_routine(SolverParallel *solver, const int i);
+  void bind_replica(const int i, Scratch &arena);
+  void start_speculation();
+  void run_speculation(const int r, Scratch &arena);
+  void subtract_removed(const double min_weight) override;
+  void approx_round() override;
+  void run_pool(const PoolTask task, const size_t count);
 
   std::vector<std::thread> threads;
+  std::vector<Scratch> thread_scratch;
   std::vector<std::pair<int, int>> thread_args;
   std::vector<std::vector<double>> thread_ret;
+  std::vector<std::vector<std::pair<double, int>>> thread_top;
   std::vector<bool> thread_status;
   std::mutex pool_mutex, master_mutex;
   std::condition_variable pool_cv, master_cv;
   int thread_done_count;
   bool terminate_pool;
+  PoolTask pool_task;
+  double pool_min_weight;
+  std::atomic<int> pinned_count;
+  // one per node on multi node hosts, refreshed when pack_count changes
+  std::vector<std::unique_ptr<NodeReplica>> replicas;
+  size_t pack_count;
+
+  // speculation state, guarded by pool_mutex
+  bool speculate;
+  size_t speculation_budget;
+  std::vector<std::vector<int>> spec_buckets;
+  std::vector<double> spec_weights;
+  std::vector<std::string> spec_guesses;
+  std::vector<int> spec_queue;
+  size_t spec_next;
+  int spec_active;
+  int spec_hits;
+  std::atomic<bool> spec_cancel;
+  std::condition_variable spec_cv;
 };
@@ -0,0 +1,81 @@
+#ifndef SOLVER_HPP
+#define SOLVER_HPP
+#include "Solver.hpp"
+#endif
+
+#ifndef ADVERSARY_HPP
+#define ADVERSARY_HPP
+#include "Adversary.hpp"
+#endif
+
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+#include "PerfCounters.hpp"
+#endif
+
+/**
+ * @brief Single threaded solver that reads hardware counters around its
+ * scoring kernels and around each move of a game
+ *
+ * Kernels are run on the full dictionary for a block of guesses, one at a
+ * time, so their counts can be compared per candidate pair:
+ *   calc_expect   words as strings, result index and log2 per pair
+ *   score_block   packed words, tiled, log2 terms computed once per word
+ *   cached rows   calc_expect with every row cached, so no result index
+ *   pack_words    one log2 per word
+ *   filter_words  one result check per word
+ * Counters are only read on the calling thread, so nothing else may run
+ * on the solver while measuring.
+ */
+class SolverBenchmark : public Solver
+{
+public:
+  /**
+   * @brief Counts summed over the runs of one kernel or move stage
+   *
+   */
+  struct Sample
+  {
+    std::string name;
+    // kernel runs or moves
+    long long calls;
+    // guess and candidate pairs scored, or words for per word kernels
+    long long pairs;
+    double ms;
+    // one per counter event, -1 where not available
+    std::vector<long long> counts;
+  };
+
+  /**
+   * @brief Construct a new Solver Benchmark object
+   *
+   * @param data_path Path to data dir containing word_weights.txt
+   */
+  SolverBenchmark(const std::string &data_path);
+
+  /**
+   * @brief Run each scoring kernel on the opening state
+   *
+   * @param counters Counters of the calling thread
+   * @param adversary Judges the guess that filter_words filters by
+   * @param guesses Guesses to score against every candidate
+   * @return std::vector<Sample> One per kernel
+   */
+  std::vector<Sample> run_kernels(PerfCounters &counters, Adversary &adversary, const size_t guesses);
+
+  /**
+   * @brief Play games against the first target words and measure each move
+   *
+   * @param counters Counters of the calling thread
+   * @param adversary Judges the guesses
+   * @param targets Target words, played in order
+   * @return std::vector<Sample> One per move stage, the opening first
+   */
+  std::vector<Sample> run_games(PerfCounters &counters, Adversary &adversary, const std::vector<std::string> &targets);
+
+private:
+  template <typename F>
+  void measure(PerfCounters &counters, Sample &sample, F &&run);
+
+  std::vector<long long> before, after;
+};
@@ -0,0 +1,136 @@
+#ifndef STDINT_H
+#define STDINT_H
+#include <stdint.h>
+#endif
+
+#ifndef STRING_H
+#define STRING_H
+#include <string>
+#endif
+
+#ifndef VECTOR_H
+#define VECTOR_H
+#include <vector>
+#endif
+
+#ifndef STDEXCEPT_H
+#define STDEXCEPT_H
+#include <stdexcept>
+#endif
+
+#ifndef FILESYSTEM_H
+#define FILESYSTEM_H
+#include <filesystem>
+namespace fs = std::filesystem;
+#endif
+
+#ifndef CONSTANTS_HPP
+#define CONSTANTS_HPP
+#include <constants.hpp>
+#endif
+
+/**
+ * @brief Compiled solver policy served by table lookup
+ *
+ * The file is a header followed by a flat array of nodes. Node 0 is the
+ * opening, and each node holds its guess plus the index of the next node
+ * for every result (0 when no target gives that result). Nothing needs to
+ * be parsed, so the file is mapped read only and shared between processes.
+ */
+class StrategyTree
+{
+public:
+  struct Header
+  {
+    char magic[4];
+    uint32_t version;
+    uint32_t node_count;
+    uint32_t reserved;
+  };
+
+  struct Node
+  {
+    char guess[5];
+    uint8_t reserved[3];
+    float entropy;
+    uint32_t child[SIZE_OF_RESULTS_SET];
+  };
+
+  /**
+   * @brief Map a compiled tree for playback
+   *
+   * @param tree_path Path to a file written by compile
+   */
+  StrategyTree(const std::string &tree_path);
+
+  /**
+   * @brief Strategy Tree move constructor
+   *
+   * @param rvalue
+   */
+  StrategyTree(StrategyTree &&rvalue) noexcept;
+
+  StrategyTree &operator=(StrategyTree &&rvalue) noexcept;
+
+  StrategyTree(const StrategyTree &) = delete;
+  StrategyTree &operator=(const StrategyTree &) = delete;
+
+  /**
+   * @brief Unmap the tree and destroy the Strategy Tree object
+   *
+   */
+  ~StrategyTree();
+
+  /**
+   * @brief Run the solver against every target word and write its decision tree
+   *
+   * @param data_path Path to data dir containing word_weights.txt and test_words.txt
+   * @param tree_path Where to write the tree
+   * @return size_t Number of nodes written
+   */
+  static size_t compile(const std::string &data_path, const std::string &tree_path);
+
+  /**
+   * @brief Reset to the opening for a new game
+   *
+   */
+  void reset();
+
+  /**
+   * @brief Make a guess
+   *
+   * @param guess Guess will be placed in here
+   */
+  void make_guess(char (&guess)[5]);
+
+  /**
+   * @brief Make a guess
+   *
+   * @param guess Guess will be placed in here
+   * @param result Result from previous guess
+   */
+  void make_guess(char (&guess)[5], const char (&result)[5]);
+
+  /**
+   * @brief Get the entropy the solver saw at the current node.
+   *
+   * @return double 0 ≤ entropy, probably less than 16
+   */
+  double get_entropy();
+
+  /**
+   * @brief Get the number of nodes in the tree
+   *
+   * @return size_t Node count
+   */
+  size_t get_node_count();
+
+private:
+  void unmap();
+
+  void *map;
+  size_t map_size;
+  const Node *nodes;
+  uint32_t node_count;
+  uint32_t cur;
+};
@@ -0,0 +1,160 @@
+#ifndef STDDEF_H
+#define STDDEF_H
+#include <stddef.h>
+#endif
+
+#ifndef STRING_H
+#define STRING_H
+#include <string>
+#endif
+
+#ifndef VECTOR_H
+#define VECTOR_H
+#include <vector>
+#endif
+
+#ifndef NEW_H
+#define NEW_H
+#include <new>
+#endif
+
+#ifndef CONSTANTS_HPP
+#define CONSTANTS_HPP
+#include <constants.hpp>
+#endif
+
+/**
+ * @brief NUMA nodes and CPUs this process may run on, read once from sysfs
+ *
+ * Hosts without /sys/devices/system/node, or with a single node, show up
+ * as one node holding every allowed CPU, so callers need no special case.
+ * Workers are handed CPUs round robin across nodes, so a pool smaller than
+ * the machine still spreads over every socket's memory bandwidth.
+ */
+class Topology
+{
+public:
+  /**
+   * @brief Get the topology of this host
+   *
+   * @return const Topology& Detected on first use
+   */
+  static const Topology &get();
+
+  /**
+   * @brief Get the number of NUMA nodes with allowed CPUs
+   *
+   * @return int At least 1
+   */
+  int get_node_count() const;
+
+  /**
+   * @brief Get the number of CPUs this process may run on
+   *
+   * @return int At least 1
+   */
+  int get_cpu_count() const;
+
+  /**
+   * @brief Get the CPU a pool worker should run on
+   *
+   * @param worker Index of the worker, wrapping around when there are more workers than CPUs
+   * @return int CPU number
+   */
+  int get_worker_cpu(const int worker) const;
+
+  /**
+   * @brief Get the node a pool worker runs on
+   *
+   * @param worker Index of the worker
+   * @return int 0 ≤ node < get_node_count()
+   */
+  int get_worker_node(const int worker) const;
+
+  /**
+   * @brief Pin the calling thread to one CPU
+   *
+   * @param cpu CPU number from get_worker_cpu
+   * @return true The thread is pinned
+   * @return false The kernel refused, and the thread runs where it did before
+   */
+  static bool pin_current_thread(const int cpu);
+
+  /**
+   * @brief Get the transparent huge page mode of the kernel
+   *
+   * @return std::string always, madvise, never, or unknown
+   */
+  static std::string get_huge_page_mode();
+
+  /**
+   * @brief Map memory aligned to huge pages and ask for them. Explicit huge
+   * pages are used when the kernel has some reserved, and transparent ones
+   * otherwise. Throws std::bad_alloc when out of memory.
+   *
+   * @param bytes Size, rounded up to HUGE_PAGE_SIZE
+   * @return void* Zeroed memory
+   */
+  static void *alloc_huge(const size_t bytes);
+
+  /**
+   * @brief Unmap memory from alloc_huge
+   *
+   * @param p Pointer from alloc_huge
+   * @param bytes Size passed to alloc_huge
+   */
+  static void free_huge(void *p, const size_t bytes);
+
+private:
+  Topology();
+
+  // allowed CPUs in worker order, and the node of each
+  std::vector<int> cpus;
+  std::vector<int> cpu_nodes;
+  int node_count;
+};
+
+/**
+ * @brief Allocator that backs tables of at least HUGE_PAGE_SIZE bytes with
+ * huge pages, so scans over them miss the TLB less. Smaller tables come
+ * from the heap as usual.
+ *
+ * @tparam T Element type
+ */
+template <typename T>
+struct HugePageAllocator
+{
+  typedef T value_type;
+
+  HugePageAllocator() = default;
+
+  template <typename U>
+  HugePageAllocator(const HugePageAllocator<U> &) noexcept {}
+
+  T *allocate(const size_t n)
+  {
+    if (n * sizeof(T) >= HUGE_PAGE_SIZE)
+      return static_cast<T *>(Topology::alloc_huge(n * sizeof(T)));
+    return static_cast<T *>(::operator new(n * sizeof(T)));
+  }
+
+  void deallocate(T *p, const size_t n) noexcept
+  {
+    if (n * sizeof(T) >= HUGE_PAGE_SIZE)
+      Topology::free_huge(p, n * sizeof(T));
+    else
+      ::operator delete(p);
+  }
+
+  template <typename U>
+  bool operator==(const HugePageAllocator<U> &) const noexcept
+  {
+    return true;
+  }
+
+  template <typename U>
+  bool operator!=(const HugePageAllocator<U> &) const noexcept
+  {
+    return false;
+  }
+};
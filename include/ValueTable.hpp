@@ -0,0 +1,82 @@
+#ifndef STRING_H
+#define STRING_H
+#include <string>
+#endif
+
+#ifndef VECTOR_H
+#define VECTOR_H
+#include <vector>
+#endif
+
+/**
+ * @brief Expected guesses to solve a state, by candidate count and entropy
+ *
+ * Rows are log2 of the candidate count and columns are entropy in fixed
+ * steps. Queries interpolate linearly along both axes. The table is fitted
+ * from solved games by src/util/fit_values.cpp and stored as text:
+ *
+ *   # comment lines
+ *   <count bins> <entropy bins> <entropy step>
+ *   <count bins> lines of <entropy bins> values
+ */
+class ValueTable
+{
+public:
+  /**
+   * @brief Construct an empty Value Table object for fitting
+   *
+   * @param count_bins Rows (at least 2), covering counts up to 2^(count_bins - 1)
+   * @param entropy_bins Columns (at least 2)
+   * @param entropy_step Bits per column
+   */
+  ValueTable(const int count_bins, const int entropy_bins, const double entropy_step);
+
+  /**
+   * @brief Load a fitted table
+   *
+   * @param path Path to a file written by save
+   */
+  ValueTable(const std::string &path);
+
+  /**
+   * @brief Get the expected number of guesses to solve a state, including the next
+   *
+   * @param count Number of candidates (at least 1)
+   * @param entropy Entropy of the candidates in bits
+   * @return double At least 1
+   */
+  double query(const int count, const double entropy) const;
+
+  /**
+   * @brief Record a solved state for fitting
+   *
+   * @param count Number of candidates
+   * @param entropy Entropy of the candidates in bits
+   * @param guesses Guesses it took from this state, including the next
+   */
+  void add_sample(const int count, const double entropy, const int guesses);
+
+  /**
+   * @brief Average the samples in each cell and fill empty cells from a line fitted to all samples
+   *
+   */
+  void fit();
+
+  /**
+   * @brief Write the fitted table
+   *
+   * @param path Destination, replaced atomically
+   */
+  void save(const std::string &path) const;
+
+private:
+  double &cell(const int c, const int e);
+  double cell(const int c, const int e) const;
+
+  int count_bins;
+  int entropy_bins;
+  double entropy_step;
+  std::vector<double> values;
+  std::vector<double> sums;
+  std::vector<int> samples;
+};
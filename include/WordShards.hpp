@@ -0,0 +1,107 @@
+#ifndef STDINT_H
+#define STDINT_H
+#include <stdint.h>
+#endif
+
+#ifndef STRING_H
+#define STRING_H
+#include <string>
+#endif
+
+#ifndef STDEXCEPT_H
+#define STDEXCEPT_H
+#include <stdexcept>
+#endif
+
+#ifndef CONSTANTS_HPP
+#define CONSTANTS_HPP
+#include <constants.hpp>
+#endif
+
+/**
+ * @brief Dictionary stored as fixed size shards in a read only mapping
+ *
+ * Each shard holds its words' -w log2 w terms, weights and letters as
+ * separate arrays in the layout the scoring loop reads, so shards are
+ * scored straight from the mapping and only the pages in use stay
+ * resident. Shards hold a multiple of 64 words, so a candidate bitmap
+ * never shares a word between shards.
+ */
+class WordShards
+{
+public:
+  struct Header
+  {
+    char magic[4];
+    uint32_t version;
+    uint32_t shard_words;
+    uint32_t shard_count;
+    uint64_t word_count;
+  };
+
+  struct Shard
+  {
+    const double *first;
+    const double *weights;
+    const char *vals;
+    // words in this shard, shard_words except in the last one
+    size_t size;
+  };
+
+  /**
+   * @brief Map compiled shards
+   *
+   * @param shards_path Path to a file written by compile
+   */
+  WordShards(const std::string &shards_path);
+
+  WordShards(const WordShards &) = delete;
+  WordShards &operator=(const WordShards &) = delete;
+
+  /**
+   * @brief Unmap the shards and destroy the Word Shards object
+   *
+   */
+  ~WordShards();
+
+  /**
+   * @brief Convert a word weights file into shards, one shard in memory at a time
+   *
+   * @param words_path Text file of "word weight" lines
+   * @param shards_path Where to write the shards
+   * @param shard_words Words per shard, rounded up to a multiple of 64
+   * @return size_t Number of words written
+   */
+  static size_t compile(const std::string &words_path, const std::string &shards_path, const size_t shard_words);
+
+  Shard get_shard(const size_t i) const;
+  size_t get_shard_count() const;
+  size_t get_shard_words() const;
+  size_t get_word_count() const;
+
+  /**
+   * @brief Get one word's letters
+   *
+   * @param id Index in the dictionary
+   * @return const char* 5 letters, not terminated
+   */
+  const char *get_val(const size_t id) const;
+
+  /**
+   * @brief Get one word's weight
+   *
+   * @param id Index in the dictionary
+   * @return double Weight
+   */
+  double get_weight(const size_t id) const;
+
+private:
+  static size_t shard_bytes(const size_t shard_words);
+
+  void *map;
+  size_t map_size;
+  const char *base;
+  size_t shard_words;
+  size_t shard_count;
+  size_t word_count;
+};
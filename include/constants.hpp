@@ -1,5 +1,66 @@
 #define TEST_WORDS_FILE_NAME "test_words.txt"
 #define WORD_WEIGHTS_FILE_NAME "word_weights.txt"
+#define STRATEGY_TREE_FILE_NAME "strategy_tree.bin"
+#define VALUE_TABLE_FILE_NAME "value_table.txt"
+#define WORD_SHARDS_FILE_NAME "word_shards.bin"
+#define OPENING_BOOK_FILE_NAME "opening_book.txt"
 
 /* Number of possible results (3^5) */
 #define SIZE_OF_RESULTS_SET 243
+
+/* Memory cap for speculative guesses in async mode (64 MiB) */
+#define SPECULATION_BUDGET_BYTES (64ul << 20)
+
+/* Give up on a game after this many guesses */
+#define MAX_GUESSES 32
+
+/* Memory cap for compressed pattern rows in low memory mode (32 MiB) */
+#define PATTERN_CACHE_BUDGET_BYTES (32ul << 20)
+
+/* Build missing pattern rows while candidates are at least 1/32 of the dictionary */
+#define PATTERN_CACHE_MIN_FRACTION 32
+
+/* Read cached pattern rows while at least this many candidates are left */
+#define PATTERN_CACHE_MIN_WORDS 32
+
+/* Cache sizes assumed when the system does not report them */
+#define DEFAULT_L1_CACHE_SIZE (32l << 10)
+#define DEFAULT_L2_CACHE_SIZE (256l << 10)
+
+/* Most guesses scored together in one cache block */
+#define MAX_GUESS_BLOCK 256
+
+/* Approximate scoring in mode r: states of at least APPROX_MIN_WORDS
+   candidates race guesses on samples until APPROX_FINALISTS are left */
+#define APPROX_MIN_WORDS 1000
+#define APPROX_INITIAL_SAMPLE 64
+#define APPROX_FINALISTS 16
+#define APPROX_Z 3.0
+
+/* Largest per guess histogram table carried across moves in mode h (64 MiB) */
+#define INCREMENTAL_BUDGET_BYTES (64ul << 20)
+
+/* Rebuild rather than subtract once fewer candidates are left, so rounding
+   left by subtraction never decides between the last few guesses */
+#define INCREMENTAL_MIN_WORDS 64
+
+/* Least time between checkpoint saves of long jobs */
+#define CHECKPOINT_INTERVAL_MS 10000
+
+/* Best guesses listed with each suggestion */
+#define RANKED_GUESSES 5
+
+/* Words per shard of a sharded dictionary (a multiple of 64) */
+#define SHARD_WORDS 4096
+
+/* Most guesses a sharded solver scores per move, above the shipped dictionary size so it stays exact */
+#define SHARD_GUESS_LIMIT 16384
+
+/* Huge page size; tables at least this big are backed by huge pages (2 MiB) */
+#define HUGE_PAGE_SIZE (2ul << 20)
+
+/* Moves covered by an opening book: 1 is the opening, 2 adds the reply to each of its results */
+#define OPENING_BOOK_DEPTH 2
+
+/* Guesses each kernel scores against every candidate in benchmark mode */
+#define BENCHMARK_GUESSES 256
@@ -1,5 +1,52 @@
+#ifndef ADVERSARY_HPP
+#define ADVERSARY_HPP
 #include "Adversary.hpp"
+#endif
+
+#ifndef SOLVER_HPP
+#define SOLVER_HPP
 #include "Solver.hpp"
+#endif
+
+#ifndef COORDINATOR_HPP
+#define COORDINATOR_HPP
+#include "Coordinator.hpp"
+#endif
+
+#ifndef SHARDED_SOLVER_HPP
+#define SHARDED_SOLVER_HPP
+#include "ShardedSolver.hpp"
+#endif
+
+#ifndef EVALUATOR_HPP
+#define EVALUATOR_HPP
+#include "Evaluator.hpp"
+#endif
+
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+#include "Checkpoint.hpp"
+#endif
+
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+#include "PerfCounters.hpp"
+#endif
+
+#ifndef SOLVER_BENCHMARK_HPP
+#define SOLVER_BENCHMARK_HPP
+#include "SolverBenchmark.hpp"
+#endif
+
+#ifndef OPENING_BOOK_HPP
+#define OPENING_BOOK_HPP
+#include "OpeningBook.hpp"
+#endif
+
+#ifndef STRATEGY_TREE_HPP
+#define STRATEGY_TREE_HPP
+#include "StrategyTree.hpp"
+#endif
 
 #ifndef CHRONO_H
 #define CHRONO_H
@@ -41,3 +88,23 @@ namespace chrono = std::chrono;
 #define IOSTREAM_H
 #include <iostream>
 #endif
+
+#ifndef NEW_H
+#define NEW_H
+#include <new>
+#endif
+
+#ifndef ATOMIC_H
+#define ATOMIC_H
+#include <atomic>
+#endif
+
+#ifndef MEMORY_H
+#define MEMORY_H
+#include <memory>
+#endif
+
+#ifndef SSTREAM_H
+#define SSTREAM_H
+#include <sstream>
+#endif
@@ -37,6 +37,11 @@ void Adversary::new_word()
   }
 }
 
+void Adversary::set_target_word(const std::string &word)
+{
+  target_word = word;
+}
+
 void Adversary::judge(const char (&guess)[5], char (&result)[5])
 {
   for (int i = 0; i < 5; i++)
@@ -73,3 +78,16 @@ std::string Adversary::get_target_word()
 {
   return target_word;
 }
+
+std::vector<std::string> Adversary::load_target_words(const std::string &data_path)
+{
+  std::ifstream word_file(fs::path(data_path) / fs::path(TEST_WORDS_FILE_NAME));
+  std::vector<std::string> targets;
+  std::string line;
+  while (std::getline(word_file, line))
+  {
+    if (!line.empty())
+      targets.push_back(line.substr(0, 5));
+  }
+  return targets;
+}
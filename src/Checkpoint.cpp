@@ -0,0 +1,141 @@
+#include "Checkpoint.hpp"
+
+#ifndef FSTREAM_H
+#define FSTREAM_H
+#include <fstream>
+#endif
+
+#ifndef ITERATOR_H
+#define ITERATOR_H
+#include <iterator>
+#endif
+
+#ifndef FILESYSTEM_H
+#define FILESYSTEM_H
+#include <filesystem>
+namespace fs = std::filesystem;
+#endif
+
+#define CHECKPOINT_MAGIC "WDLC"
+#define CHECKPOINT_VERSION 2
+
+namespace
+{
+  const uint64_t FNV_OFFSET = 14695981039346656037ull;
+  const uint64_t FNV_PRIME = 1099511628211ull;
+
+  uint64_t fnv1a(uint64_t hash, const char *p, size_t n)
+  {
+    while (n-- > 0)
+    {
+      hash = (hash ^ (unsigned char)*p++) * FNV_PRIME;
+    }
+    return hash;
+  }
+}
+
+Checkpoint::Checkpoint(const std::string &path_, const uint32_t kind_, const uint64_t key_)
+    : path(path_), kind(kind_), key(key_), read_pos(0), loaded(false)
+{
+}
+
+bool Checkpoint::load()
+{
+  loaded = false;
+  std::ifstream in(path, std::ios::binary);
+  if (!in)
+    return false;
+  Header header;
+  if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)) || std::memcmp(header.magic, CHECKPOINT_MAGIC, 4) != 0 || header.version != CHECKPOINT_VERSION)
+    throw std::runtime_error("bad checkpoint " + path);
+  // never resume progress that belongs to another job
+  if (header.kind != kind || header.key != key)
+    throw std::runtime_error("checkpoint " + path + " was written by a different job");
+  // the size comes from the file, so check it before allocating for it
+  std::error_code ec;
+  const uintmax_t file_size = fs::file_size(path, ec);
+  if (ec || file_size < sizeof(header) || header.payload_size != file_size - sizeof(header))
+    throw std::runtime_error("truncated checkpoint " + path);
+  payload.resize(header.payload_size);
+  if (!in.read(payload.data(), payload.size()))
+    throw std::runtime_error("truncated checkpoint " + path);
+  if ((uint32_t)fnv1a(FNV_OFFSET, payload.data(), payload.size()) != header.checksum)
+    throw std::runtime_error("damaged checkpoint " + path);
+  read_pos = 0;
+  loaded = true;
+  return true;
+}
+
+bool Checkpoint::is_loaded() const
+{
+  return loaded;
+}
+
+const std::string &Checkpoint::get_path() const
+{
+  return path;
+}
+
+void Checkpoint::save()
+{
+  Header header;
+  std::memcpy(header.magic, CHECKPOINT_MAGIC, 4);
+  header.version = CHECKPOINT_VERSION;
+  header.kind = kind;
+  header.checksum = fnv1a(FNV_OFFSET, payload.data(), payload.size());
+  header.key = key;
+  header.payload_size = payload.size();
+  const std::string temp_path = path + ".tmp";
+  {
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(payload.data(), payload.size());
+    if (!out)
+      throw std::runtime_error("cannot write " + temp_path);
+  }
+  fs::rename(temp_path, path);
+}
+
+void Checkpoint::remove()
+{
+  std::error_code ec;
+  fs::remove(path, ec);
+}
+
+void Checkpoint::set_aside()
+{
+  std::error_code ec;
+  fs::rename(path, path + ".bad", ec);
+  if (ec)
+    fs::remove(path, ec);
+  clear();
+  loaded = false;
+}
+
+void Checkpoint::clear()
+{
+  payload.clear();
+  read_pos = 0;
+}
+
+void Checkpoint::read(void *dst, const size_t n)
+{
+  if (n > payload.size() - read_pos)
+    throw std::runtime_error("truncated checkpoint " + path);
+  std::memcpy(dst, payload.data() + read_pos, n);
+  read_pos += n;
+}
+
+uint64_t Checkpoint::make_key(const std::vector<std::string> &paths, const uint64_t salt)
+{
+  uint64_t hash = fnv1a(FNV_OFFSET, reinterpret_cast<const char *>(&salt), sizeof(salt));
+  for (const auto &file_path : paths)
+  {
+    std::ifstream in(file_path, std::ios::binary);
+    if (!in)
+      throw std::runtime_error("cannot open " + file_path);
+    const std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    hash = fnv1a(hash, contents.data(), contents.size());
+  }
+  return hash;
+}
@@ -0,0 +1,290 @@
+#include "Coordinator.hpp"
+
+#ifndef SYS_SOCKET_H
+#define SYS_SOCKET_H
+#include <sys/socket.h>
+#endif
+
+#ifndef SYS_WAIT_H
+#define SYS_WAIT_H
+#include <sys/wait.h>
+#endif
+
+#ifndef POLL_H
+#define POLL_H
+#include <poll.h>
+#endif
+
+#ifndef ERRNO_H
+#define ERRNO_H
+#include <errno.h>
+#endif
+
+#ifndef CHRONO_H
+#define CHRONO_H
+#include <chrono>
+namespace chrono = std::chrono;
+#endif
+
+/* Tasks queued on a worker before it reports back */
+#define WORKER_QUEUE_DEPTH 2
+
+namespace
+{
+  /*
+  Records are arrays of int32. A task is {target index} with -1 meaning
+  exit, and a result is {target index, guess count}.
+  */
+  bool write_all(const int fd, const void *buf, size_t n)
+  {
+    const char *p = static_cast<const char *>(buf);
+    while (n > 0)
+    {
+      ssize_t k = send(fd, p, n, MSG_NOSIGNAL);
+      if (k < 0 && errno == EINTR)
+        continue;
+      if (k <= 0)
+        return false;
+      p += k;
+      n -= k;
+    }
+    return true;
+  }
+
+  bool read_all(const int fd, void *buf, size_t n)
+  {
+    char *p = static_cast<char *>(buf);
+    while (n > 0)
+    {
+      ssize_t k = read(fd, p, n);
+      if (k < 0 && errno == EINTR)
+        continue;
+      if (k <= 0)
+        return false;
+      p += k;
+      n -= k;
+    }
+    return true;
+  }
+}
+
+Coordinator::Coordinator(const std::string &data_path, const int num_workers, Checkpoint *checkpoint_)
+    : solver(data_path), adversary(data_path), targets(Adversary::load_target_words(data_path)),
+      workers(std::max(1, num_workers)), respawn_count(0), checkpoint(checkpoint_), results(targets.size(), 0), resumed_count(0)
+{
+  if (targets.empty())
+    throw std::runtime_error("no target words in " + data_path);
+  if (checkpoint && checkpoint->is_loaded())
+  {
+    try
+    {
+      // payload: opening guess, then guess count per target with 0 for unsolved
+      std::vector<char> opening;
+      checkpoint->get(opening);
+      checkpoint->get(results);
+      if (results.size() != targets.size())
+        throw std::runtime_error("checkpoint does not match the target words");
+      if (!opening.empty())
+        solver.set_opening_guess(std::string(opening.begin(), opening.end()));
+      resumed_count = targets.size() - std::count(results.begin(), results.end(), 0);
+    }
+    catch (const std::runtime_error &e)
+    {
+      std::cerr << e.what() << ", moved to " << checkpoint->get_path() << ".bad, starting fresh\n";
+      checkpoint->set_aside();
+      results.assign(targets.size(), 0);
+      resumed_count = 0;
+    }
+  }
+  // cache the opening guess so every forked worker starts with it
+  char word[5];
+  solver.make_guess(word);
+  solver.reset();
+  for (size_t i = 0; i < workers.size(); i++)
+  {
+    workers[i].pid = -1;
+    workers[i].fd = -1;
+    spawn(i);
+  }
+}
+
+Coordinator::~Coordinator()
+{
+  const int exit_task = -1;
+  for (auto &worker : workers)
+  {
+    if (worker.fd < 0)
+      continue;
+    write_all(worker.fd, &exit_task, sizeof(exit_task));
+    close(worker.fd);
+    waitpid(worker.pid, nullptr, 0);
+  }
+}
+
+const std::vector<std::string> &Coordinator::get_targets()
+{
+  return targets;
+}
+
+int Coordinator::get_respawn_count()
+{
+  return respawn_count;
+}
+
+size_t Coordinator::get_resumed_count()
+{
+  return resumed_count;
+}
+
+void Coordinator::save_checkpoint()
+{
+  const std::string opening = solver.get_opening_guess();
+  checkpoint->clear();
+  checkpoint->put(std::vector<char>(opening.begin(), opening.end()));
+  checkpoint->put(results);
+  checkpoint->save();
+}
+
+std::vector<int> Coordinator::sweep()
+{
+  std::deque<int> pending;
+  size_t done = 0;
+  for (size_t i = 0; i < targets.size(); i++)
+  {
+    if (results[i] == 0)
+      pending.push_back(i);
+    else
+      done++;
+  }
+  chrono::steady_clock::time_point last_save = chrono::steady_clock::now();
+  const int max_respawns = 4 * workers.size();
+  std::vector<pollfd> fds(workers.size());
+  while (done < targets.size())
+  {
+    // top up every live worker
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+      while (workers[i].fd >= 0 && !pending.empty() && workers[i].in_flight.size() < WORKER_QUEUE_DEPTH)
+      {
+        const int task = pending.front();
+        if (!write_all(workers[i].fd, &task, sizeof(task)))
+        {
+          reap(i, pending);
+          break;
+        }
+        pending.pop_front();
+        workers[i].in_flight.push_back(task);
+      }
+    }
+    int live = 0;
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+      fds[i].fd = workers[i].fd;
+      fds[i].events = POLLIN;
+      fds[i].revents = 0;
+      live += workers[i].fd >= 0;
+    }
+    if (live == 0)
+      throw std::runtime_error("all workers died");
+    if (poll(fds.data(), fds.size(), -1) < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      throw std::runtime_error("poll failed");
+    }
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+      if (workers[i].fd < 0 || fds[i].revents == 0)
+        continue;
+      int record[2];
+      if (!(fds[i].revents & POLLIN) || !read_all(workers[i].fd, record, sizeof(record)))
+      {
+        reap(i, pending);
+        if (respawn_count < max_respawns)
+        {
+          respawn_count++;
+          spawn(i);
+        }
+        continue;
+      }
+      ASSERT(workers[i].in_flight.empty(), ==, false);
+      ASSERT(workers[i].in_flight.front(), ==, record[0]);
+      workers[i].in_flight.pop_front();
+      if (record[1] < 0)
+        throw std::runtime_error("worker failed on " + targets[record[0]]);
+      // results land by target index, so arrival order does not matter
+      results[record[0]] = record[1];
+      done++;
+    }
+    if (checkpoint && chrono::steady_clock::now() - last_save >= chrono::milliseconds(CHECKPOINT_INTERVAL_MS))
+    {
+      save_checkpoint();
+      last_save = chrono::steady_clock::now();
+    }
+  }
+  return results;
+}
+
+void Coordinator::spawn(const size_t i)
+{
+  int sv[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0)
+    throw std::runtime_error("socketpair failed");
+  std::cout.flush();
+  std::cerr.flush();
+  const pid_t pid = fork();
+  if (pid < 0)
+    throw std::runtime_error("fork failed");
+  if (pid == 0)
+  {
+    close(sv[0]);
+    // drop the sockets of other workers so their EOF reaches the coordinator
+    for (const auto &worker : workers)
+    {
+      if (worker.fd >= 0)
+        close(worker.fd);
+    }
+    worker_loop(sv[1]);
+    _exit(EXIT_SUCCESS);
+  }
+  close(sv[1]);
+  workers[i].pid = pid;
+  workers[i].fd = sv[0];
+  workers[i].in_flight.clear();
+}
+
+void Coordinator::reap(const size_t i, std::deque<int> &pending)
+{
+  close(workers[i].fd);
+  waitpid(workers[i].pid, nullptr, 0);
+  workers[i].fd = -1;
+  workers[i].pid = -1;
+  // hand unfinished targets back, oldest first
+  while (!workers[i].in_flight.empty())
+  {
+    pending.push_front(workers[i].in_flight.back());
+    workers[i].in_flight.pop_back();
+  }
+}
+
+void Coordinator::worker_loop(const int fd)
+{
+  int task;
+  while (read_all(fd, &task, sizeof(task)) && task >= 0)
+  {
+    int record[2] = {task, -1};
+    try
+    {
+      adversary.set_target_word(targets[task]);
+      record[1] = play_target(solver, adversary);
+    }
+    catch (const std::exception &e)
+    {
+      std::cerr << e.what() << '\n';
+      solver.reset();
+    }
+    if (!write_all(fd, record, sizeof(record)))
+      break;
+  }
+  close(fd);
+}
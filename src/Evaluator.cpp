@@ -0,0 +1,165 @@
+#include "Evaluator.hpp"
+
+#ifndef THREAD_H
+#define THREAD_H
+#include <thread>
+#endif
+
+#ifndef EXCEPTION_H
+#define EXCEPTION_H
+#include <exception>
+#endif
+
+Evaluator::Evaluator(const std::string &data_path, const int num_threads)
+    : targets(Adversary::load_target_words(data_path)), results(targets.size(), 0), node_count(0)
+{
+  if (targets.empty())
+    throw std::runtime_error("no target words in " + data_path);
+  for (int i = 0; i < std::max(1, num_threads); i++)
+  {
+    solvers.emplace_back(data_path);
+    adversaries.emplace_back(data_path);
+  }
+}
+
+void Evaluator::set_word_weight(const std::string &word, const double weight)
+{
+  for (auto &solver : solvers)
+  {
+    solver.set_word_weight(word, weight);
+  }
+}
+
+void Evaluator::enable_pattern_cache(const std::shared_ptr<PatternCache> &cache)
+{
+  for (auto &solver : solvers)
+  {
+    solver.enable_pattern_cache(cache);
+  }
+}
+
+const std::vector<std::string> &Evaluator::get_targets()
+{
+  return targets;
+}
+
+size_t Evaluator::get_node_count()
+{
+  return node_count;
+}
+
+std::vector<int> Evaluator::evaluate()
+{
+  std::fill(results.begin(), results.end(), 0);
+  node_count = 1;
+  std::vector<int> all(targets.size());
+  for (size_t t = 0; t < targets.size(); t++)
+  {
+    all[t] = t;
+  }
+
+  // the opening is shared by every thread, so score it once
+  char opening[5];
+  solvers[0].make_guess(opening);
+  for (size_t i = 1; i < solvers.size(); i++)
+  {
+    solvers[i].set_opening_guess(solvers[0].get_opening_guess());
+  }
+  std::vector<Branch> branches;
+  split(adversaries[0], opening, all, 1, branches);
+  Solver::Snapshot root;
+  solvers[0].save_snapshot(root);
+  std::sort(branches.begin(), branches.end(), [](const Branch &a, const Branch &b)
+            { return a.targets.size() > b.targets.size(); });
+
+  std::atomic<size_t> next(0);
+  // an exception must not leave a worker's thread, so each worker keeps its
+  // own and the first one is rethrown once every thread has been joined
+  std::vector<std::exception_ptr> errors(solvers.size());
+  auto work = [&](const size_t i)
+  {
+    try
+    {
+      char guess[5];
+      for (size_t b = next++; b < branches.size(); b = next++)
+      {
+        solvers[i].restore_snapshot(root);
+        solvers[i].make_guess(guess, branches[b].result);
+        node_count++;
+        walk(solvers[i], adversaries[i], guess, branches[b].targets, 2);
+      }
+    }
+    catch (...)
+    {
+      errors[i] = std::current_exception();
+      next = branches.size();
+    }
+    solvers[i].reset();
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < solvers.size(); i++)
+  {
+    threads.emplace_back(work, i);
+  }
+  work(0);
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
+  for (const auto &error : errors)
+  {
+    if (error)
+      std::rethrow_exception(error);
+  }
+  return results;
+}
+
+void Evaluator::split(Adversary &adversary, const char (&guess)[5], const std::vector<int> &node_targets, const int depth, std::vector<Branch> &branches)
+{
+  if (depth > MAX_GUESSES)
+    throw std::runtime_error("no solution for " + targets[node_targets.front()]);
+  // index of each result's branch, or -1
+  int branch_of[SIZE_OF_RESULTS_SET];
+  std::fill(std::begin(branch_of), std::end(branch_of), -1);
+  char res[5];
+  for (const int t : node_targets)
+  {
+    adversary.set_target_word(targets[t]);
+    adversary.judge(guess, res);
+    if (std::count(std::begin(res), std::end(res), 'G') == 5)
+    {
+      // each target is in exactly one leaf, so threads never share a slot
+      results[t] = depth;
+      continue;
+    }
+    const int r = Solver::result_to_index(res);
+    if (branch_of[r] < 0)
+    {
+      branch_of[r] = branches.size();
+      branches.emplace_back();
+      std::copy(std::begin(res), std::end(res), branches.back().result);
+    }
+    branches[branch_of[r]].targets.push_back(t);
+  }
+}
+
+void Evaluator::walk(Solver &solver, Adversary &adversary, const char (&guess)[5], const std::vector<int> &node_targets, const int depth)
+{
+  std::vector<Branch> branches;
+  split(adversary, guess, node_targets, depth, branches);
+  if (branches.empty())
+    return;
+  Solver::Snapshot snapshot;
+  if (branches.size() > 1)
+    solver.save_snapshot(snapshot);
+  char next[5];
+  for (size_t b = 0; b < branches.size(); b++)
+  {
+    // the first branch continues from the live state, the rest branch off the snapshot
+    if (b > 0)
+      solver.restore_snapshot(snapshot);
+    solver.make_guess(next, branches[b].result);
+    node_count++;
+    walk(solver, adversary, next, branches[b].targets, depth + 1);
+  }
+}
@@ -0,0 +1,163 @@
+#include "OpeningBook.hpp"
+
+#ifndef ADVERSARY_HPP
+#define ADVERSARY_HPP
+#include "Adversary.hpp"
+#endif
+
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+#include "Checkpoint.hpp"
+#endif
+
+#ifndef SSTREAM_H
+#define SSTREAM_H
+#include <sstream>
+#endif
+
+#ifndef FUNCTIONAL_H
+#define FUNCTIONAL_H
+#include <functional>
+#endif
+
+OpeningBook::OpeningBook()
+    : key(0)
+{
+}
+
+OpeningBook::OpeningBook(const std::string &book_path)
+{
+  std::ifstream file(book_path);
+  if (!file)
+    throw std::runtime_error("cannot open " + book_path);
+  std::string line;
+  while (std::getline(file, line) && (line.empty() || line[0] == '#'))
+    ;
+  std::istringstream header(line);
+  if (!(header >> key))
+    throw std::runtime_error("bad opening book " + book_path);
+  while (std::getline(file, line))
+  {
+    if (line.empty())
+      continue;
+    const size_t bar = line.find('|');
+    if (bar == std::string::npos)
+      throw std::runtime_error("bad opening book " + book_path);
+    // histories are stored with single spaces, so only the ends need trimming
+    std::string history = line.substr(0, bar);
+    history.erase(history.find_last_not_of(' ') + 1);
+    std::istringstream in(line.substr(bar + 1));
+    std::vector<Solver::RankedGuess> ranking;
+    Solver::RankedGuess ranked;
+    while (in >> ranked.word >> ranked.score >> ranked.bucket_count >> ranked.largest_bucket >> ranked.entropy)
+    {
+      ranking.push_back(ranked);
+    }
+    if (ranking.empty() || !in.eof())
+      throw std::runtime_error("bad opening book " + book_path);
+    entries[history] = std::move(ranking);
+  }
+}
+
+size_t OpeningBook::compile(const std::string &data_path, const std::string &book_path, const int depth, const size_t k)
+{
+  SolverParallel solver(data_path);
+  solver.enable_ranking(k);
+  Adversary adversary(data_path);
+  // the dictionary in solver index order, to name the candidates of a snapshot
+  std::vector<std::string> dictionary;
+  {
+    std::ifstream word_file(fs::path(data_path) / fs::path(WORD_WEIGHTS_FILE_NAME));
+    std::string line;
+    while (std::getline(word_file, line))
+    {
+      if (!line.empty())
+        dictionary.push_back(line.substr(0, 5));
+    }
+  }
+
+  std::vector<std::pair<std::string, std::vector<Solver::RankedGuess>>> states;
+  std::function<void(const std::string &, const int)> visit = [&](const std::string &history, const int moves_left)
+  {
+    char word[5], res[5];
+    solver.make_guess(word);
+    states.push_back(std::make_pair(history, solver.get_ranking()));
+    if (moves_left <= 1)
+      return;
+    Solver::Snapshot snapshot;
+    solver.save_snapshot(snapshot);
+    // every result a candidate can give, in dictionary order of first appearance
+    std::vector<std::string> results;
+    for (const int id : snapshot.ids)
+    {
+      adversary.set_target_word(dictionary[id]);
+      adversary.judge(word, res);
+      const std::string result(res, 5);
+      if (result != "GGGGG" && std::find(results.begin(), results.end(), result) == results.end())
+        results.push_back(result);
+    }
+    const std::string guess(word, 5);
+    for (const auto &result : results)
+    {
+      std::copy(result.begin(), result.end(), res);
+      solver.restore_snapshot(snapshot);
+      solver.apply_result(guess, res);
+      visit(extend(history, guess, result), moves_left - 1);
+    }
+  };
+  visit("", std::max(1, depth));
+
+  const std::string temp_path = book_path + ".tmp";
+  {
+    std::ofstream file(temp_path, std::ios::trunc);
+    file << "# ranked guesses by moves played, from the opening following the solver's suggestions\n"
+         << "# history | word score buckets largest_bucket entropy ...\n"
+         << make_key(data_path) << '\n';
+    file.precision(17);
+    for (const auto &state : states)
+    {
+      file << state.first << " |";
+      for (const auto &ranked : state.second)
+      {
+        file << ' ' << ranked.word << ' ' << ranked.score << ' ' << ranked.bucket_count << ' ' << ranked.largest_bucket << ' ' << ranked.entropy;
+      }
+      file << '\n';
+    }
+    if (!file)
+      throw std::runtime_error("cannot write " + temp_path);
+  }
+  fs::rename(temp_path, book_path);
+  return states.size();
+}
+
+uint64_t OpeningBook::make_key(const std::string &data_path)
+{
+  return Checkpoint::make_key({(fs::path(data_path) / fs::path(WORD_WEIGHTS_FILE_NAME)).string()}, 0);
+}
+
+std::string OpeningBook::extend(const std::string &history, const std::string &guess, const std::string &result)
+{
+  return history.empty() ? guess + ' ' + result : history + ' ' + guess + ' ' + result;
+}
+
+const std::vector<Solver::RankedGuess> *OpeningBook::find(const std::string &history) const
+{
+  const auto it = entries.find(history);
+  return it == entries.end() ? nullptr : &it->second;
+}
+
+void OpeningBook::insert(const std::string &history, const std::vector<Solver::RankedGuess> &ranking)
+{
+  ASSERT(ranking.empty(), ==, false);
+  entries[history] = ranking;
+}
+
+uint64_t OpeningBook::get_key() const
+{
+  return key;
+}
+
+size_t OpeningBook::get_entry_count() const
+{
+  return entries.size();
+}
@@ -0,0 +1,276 @@
+#include "PatternCache.hpp"
+
+#ifndef ALGORITHM_H
+#define ALGORITHM_H
+#include <algorithm>
+#endif
+
+#ifndef CSTRING_H
+#define CSTRING_H
+#include <cstring>
+#endif
+
+#ifndef CONSTANTS_HPP
+#define CONSTANTS_HPP
+#include <constants.hpp>
+#endif
+
+/* Codes 0-14 index the row table, 15 means a literal byte follows */
+#define PATTERN_TABLE_SIZE 15
+#define PATTERN_ESCAPE 15
+
+/* Codes per block, each block storing the count of literals before it */
+#define PATTERN_BLOCK 64
+
+/* Bookkeeping per row on top of the blob (list node, map node, vector) */
+#define PATTERN_ROW_OVERHEAD 96
+
+PatternCache::PatternCache(const size_t budget_bytes)
+    : budget(budget_bytes), used(0), hits(0), misses(0), evictions(0)
+{
+}
+
+bool PatternCache::lookup(const int guess, std::vector<uint8_t> &row)
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  auto it = rows.find(guess);
+  if (it == rows.end())
+  {
+    misses++;
+    return false;
+  }
+  hits++;
+  order.splice(order.begin(), order, it->second.order);
+  decode(it->second.blob, row);
+  return true;
+}
+
+bool PatternCache::lookup(const int guess, const int *ids, const size_t count, uint8_t *out)
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  auto it = rows.find(guess);
+  if (it == rows.end())
+  {
+    misses++;
+    return false;
+  }
+  const uint8_t *blob = it->second.blob.data();
+  uint32_t n;
+  std::memcpy(&n, blob, 4);
+  const uint8_t *table = blob + 4;
+  const uint8_t *codes = table + PATTERN_TABLE_SIZE;
+  const uint8_t *offsets = codes + (n + 1) / 2;
+  const uint8_t *literals = offsets + 4 * ((n + PATTERN_BLOCK - 1) / PATTERN_BLOCK);
+  for (size_t k = 0; k < count; k++)
+  {
+    const uint32_t i = ids[k];
+    if (i >= n)
+    {
+      // the row is older than the word, so let the caller rebuild it
+      misses++;
+      return false;
+    }
+    const uint8_t c = (i & 1) ? codes[i / 2] >> 4 : codes[i / 2] & 0xf;
+    if (c != PATTERN_ESCAPE)
+    {
+      out[k] = table[c];
+      continue;
+    }
+    // escapes are rare, so count the ones before this entry in its block
+    uint32_t literal;
+    std::memcpy(&literal, offsets + 4 * (i / PATTERN_BLOCK), 4);
+    for (uint32_t j = i - i % PATTERN_BLOCK; j < i; j++)
+    {
+      literal += ((j & 1) ? codes[j / 2] >> 4 : codes[j / 2] & 0xf) == PATTERN_ESCAPE;
+    }
+    out[k] = literals[literal];
+  }
+  hits++;
+  order.splice(order.begin(), order, it->second.order);
+  return true;
+}
+
+void PatternCache::insert(const int guess, const std::vector<uint8_t> &row)
+{
+  std::vector<uint8_t> blob;
+  encode(row, blob);
+  const size_t cost = blob.size() + PATTERN_ROW_OVERHEAD;
+  if (cost > budget)
+    return;
+  std::unique_lock<std::mutex> lock(mutex);
+  auto it = rows.find(guess);
+  if (it != rows.end())
+  {
+    if (std::memcmp(it->second.blob.data(), blob.data(), 4) == 0)
+    {
+      // another thread got here first
+      order.splice(order.begin(), order, it->second.order);
+      return;
+    }
+    // the stored row is older than the dictionary, so replace it
+    used -= it->second.blob.size() + PATTERN_ROW_OVERHEAD;
+    order.erase(it->second.order);
+    rows.erase(it);
+  }
+  while (used + cost > budget)
+  {
+    evict();
+  }
+  order.push_front(guess);
+  rows.emplace(guess, Entry{order.begin(), std::move(blob)});
+  used += cost;
+}
+
+void PatternCache::patch(const int guess, const size_t index, const uint8_t result)
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  auto it = rows.find(guess);
+  if (it == rows.end())
+    return;
+  std::vector<uint8_t> row;
+  decode(it->second.blob, row);
+  if (index > row.size())
+  {
+    // a gap cannot be filled here, so let the row be rebuilt
+    used -= it->second.blob.size() + PATTERN_ROW_OVERHEAD;
+    order.erase(it->second.order);
+    rows.erase(it);
+    return;
+  }
+  if (index == row.size())
+    row.push_back(result);
+  else
+    row[index] = result;
+  used -= it->second.blob.size();
+  encode(row, it->second.blob);
+  used += it->second.blob.size();
+  while (used > budget)
+  {
+    evict();
+  }
+}
+
+std::vector<int> PatternCache::get_guesses()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  return std::vector<int>(order.begin(), order.end());
+}
+
+void PatternCache::clear()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  rows.clear();
+  order.clear();
+  used = 0;
+}
+
+double PatternCache::get_hit_rate()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  if (hits + misses == 0)
+    return 0;
+  return (double)hits / (hits + misses);
+}
+
+long long PatternCache::get_hits()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  return hits;
+}
+
+long long PatternCache::get_misses()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  return misses;
+}
+
+long long PatternCache::get_evictions()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  return evictions;
+}
+
+size_t PatternCache::get_bytes_used()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  return used;
+}
+
+size_t PatternCache::get_row_count()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  return rows.size();
+}
+
+void PatternCache::evict()
+{
+  const int victim = order.back();
+  order.pop_back();
+  auto it = rows.find(victim);
+  used -= it->second.blob.size() + PATTERN_ROW_OVERHEAD;
+  rows.erase(it);
+  evictions++;
+}
+
+void PatternCache::encode(const std::vector<uint8_t> &row, std::vector<uint8_t> &blob)
+{
+  /*
+  blob = [n (4 bytes)][table (15 bytes)][codes (ceil(n / 2) bytes)]
+         [literals before each block (4 bytes per PATTERN_BLOCK codes)][literals]
+  Most guesses put the bulk of the dictionary in a handful of results, so
+  the table usually covers all but a few percent of the row.
+  */
+  const uint32_t n = row.size();
+  int count[SIZE_OF_RESULTS_SET] = {0};
+  for (const uint8_t r : row)
+  {
+    count[r]++;
+  }
+  uint8_t table[PATTERN_TABLE_SIZE];
+  uint8_t code[SIZE_OF_RESULTS_SET];
+  std::fill(std::begin(code), std::end(code), PATTERN_ESCAPE);
+  for (int i = 0; i < PATTERN_TABLE_SIZE; i++)
+  {
+    const int r = std::max_element(std::begin(count), std::end(count)) - std::begin(count);
+    table[i] = r;
+    if (count[r] > 0)
+      code[r] = i;
+    count[r] = -1;
+  }
+  const uint32_t blocks = (n + PATTERN_BLOCK - 1) / PATTERN_BLOCK;
+  blob.assign(4 + PATTERN_TABLE_SIZE + (n + 1) / 2 + 4 * blocks, 0);
+  std::memcpy(blob.data(), &n, 4);
+  std::memcpy(blob.data() + 4, table, PATTERN_TABLE_SIZE);
+  uint8_t *codes = blob.data() + 4 + PATTERN_TABLE_SIZE;
+  uint8_t *offsets = codes + (n + 1) / 2;
+  std::vector<uint8_t> literals;
+  for (uint32_t i = 0; i < n; i++)
+  {
+    if (i % PATTERN_BLOCK == 0)
+    {
+      const uint32_t before = literals.size();
+      std::memcpy(offsets + 4 * (i / PATTERN_BLOCK), &before, 4);
+    }
+    const uint8_t c = code[row[i]];
+    codes[i / 2] |= (i & 1) ? c << 4 : c;
+    if (c == PATTERN_ESCAPE)
+      literals.push_back(row[i]);
+  }
+  blob.insert(blob.end(), literals.begin(), literals.end());
+  blob.shrink_to_fit();
+}
+
+void PatternCache::decode(const std::vector<uint8_t> &blob, std::vector<uint8_t> &row)
+{
+  uint32_t n;
+  std::memcpy(&n, blob.data(), 4);
+  row.resize(n);
+  const uint8_t *table = blob.data() + 4;
+  const uint8_t *codes = table + PATTERN_TABLE_SIZE;
+  const uint8_t *literal = codes + (n + 1) / 2 + 4 * ((n + PATTERN_BLOCK - 1) / PATTERN_BLOCK);
+  for (uint32_t i = 0; i < n; i++)
+  {
+    const uint8_t c = (i & 1) ? codes[i / 2] >> 4 : codes[i / 2] & 0xf;
+    row[i] = c == PATTERN_ESCAPE ? *literal++ : table[c];
+  }
+}
@@ -0,0 +1,111 @@
+#include "PerfCounters.hpp"
+
+#ifndef CSTRING_H
+#define CSTRING_H
+#include <cstring>
+#endif
+
+#ifndef ALGORITHM_H
+#define ALGORITHM_H
+#include <algorithm>
+#endif
+
+#ifndef UNISTD_H
+#define UNISTD_H
+#include <unistd.h>
+#endif
+
+#ifndef SYS_SYSCALL_H
+#define SYS_SYSCALL_H
+#include <sys/syscall.h>
+#endif
+
+#ifndef LINUX_PERF_EVENT_H
+#define LINUX_PERF_EVENT_H
+#include <linux/perf_event.h>
+#endif
+
+namespace
+{
+  uint64_t cache_event(const uint64_t cache, const uint64_t op, const uint64_t result)
+  {
+    return cache | (op << 8) | (result << 16);
+  }
+}
+
+PerfCounters::PerfCounters(const std::vector<Event> &events_, const bool inherit)
+    : events(events_), fds(events_.size(), -1)
+{
+  for (size_t i = 0; i < events.size(); i++)
+  {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = events[i].type;
+    attr.config = events[i].config;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.inherit = inherit;
+    fds[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+  }
+}
+
+PerfCounters::~PerfCounters()
+{
+  for (const int fd : fds)
+  {
+    if (fd >= 0)
+      close(fd);
+  }
+}
+
+std::vector<PerfCounters::Event> PerfCounters::placement_events()
+{
+  return {
+      {"dTLB load misses", PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+      {"dTLB loads", PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_ACCESS)},
+      {"remote node loads", PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_NODE, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+      {"node loads", PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_NODE, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_ACCESS)},
+  };
+}
+
+std::vector<PerfCounters::Event> PerfCounters::profile_events()
+{
+  // task clock is a software event, so it still counts on hosts without a PMU
+  return {
+      {"task clock ns", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+      {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+      {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+      {"branch misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+      {"L1d load misses", PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+      {"LLC load misses", PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+      {"frontend stall cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_FRONTEND},
+      {"backend stall cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_BACKEND},
+  };
+}
+
+const std::vector<PerfCounters::Event> &PerfCounters::get_events()
+{
+  return events;
+}
+
+size_t PerfCounters::get_available_count()
+{
+  return std::count_if(fds.begin(), fds.end(), [](const int fd)
+                       { return fd >= 0; });
+}
+
+void PerfCounters::read(std::vector<long long> &values)
+{
+  values.resize(fds.size());
+  for (size_t i = 0; i < fds.size(); i++)
+  {
+    // value, time enabled, time running
+    uint64_t buf[3];
+    values[i] = -1;
+    if (fds[i] < 0 || ::read(fds[i], buf, sizeof(buf)) != sizeof(buf))
+      continue;
+    values[i] = buf[2] == 0 ? 0 : buf[2] < buf[1] ? (long long)((double)buf[0] * buf[1] / buf[2]) : (long long)buf[0];
+  }
+}
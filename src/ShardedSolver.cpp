@@ -0,0 +1,294 @@
+#include "ShardedSolver.hpp"
+
+#ifndef SOLVER_HPP
+#define SOLVER_HPP
+#include "Solver.hpp"
+#endif
+
+#ifndef MATH_H
+#define MATH_H
+#include <math.h>
+#endif
+
+#ifndef CSTRING_H
+#define CSTRING_H
+#include <cstring>
+#endif
+
+#ifndef ALGORITHM_H
+#define ALGORITHM_H
+#include <algorithm>
+#endif
+
+#ifndef LIMITS_H
+#define LIMITS_H
+#include <limits>
+#endif
+
+#ifndef THREAD_H
+#define THREAD_H
+#include <thread>
+#endif
+
+
+ShardedSolver::ShardedSolver(const std::string &shards_path, const size_t guess_limit_)
+    : shards(shards_path), guess_limit(std::max<size_t>(1, guess_limit_)),
+      thread_hist(std::max(1u, std::thread::hardware_concurrency())),
+      thread_best(thread_hist.size()), pool_generation(0), pool_done(0), terminate_pool(false), next_block(0)
+{
+  for (auto &hist : thread_hist)
+  {
+    hist.resize(MAX_GUESS_BLOCK * SIZE_OF_RESULTS_SET);
+  }
+  guesses.reserve(guess_limit);
+  reset();
+  for (size_t t = 1; t < thread_hist.size(); t++)
+  {
+    threads.emplace_back(thread_start_routine, this, t);
+  }
+}
+
+ShardedSolver::~ShardedSolver()
+{
+  {
+    std::unique_lock<std::mutex> lock(pool_mutex);
+    terminate_pool = true;
+  }
+  pool_cv.notify_all();
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
+}
+
+void ShardedSolver::thread_start_routine(ShardedSolver *solver, const size_t thread)
+{
+  uint64_t generation = 0;
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(solver->pool_mutex);
+      solver->pool_cv.wait(lock, [&]()
+                           { return solver->terminate_pool || solver->pool_generation != generation; });
+      if (solver->terminate_pool)
+        return;
+      generation = solver->pool_generation;
+    }
+    solver->score_blocks(thread);
+    {
+      std::unique_lock<std::mutex> lock(solver->pool_mutex);
+      solver->pool_done++;
+    }
+    solver->master_cv.notify_all();
+  }
+}
+
+void ShardedSolver::reset()
+{
+  const size_t n = shards.get_word_count();
+  live.assign((n + 63) / 64, ~0ull);
+  if (n % 64)
+    live.back() = (1ull << (n % 64)) - 1;
+  count = n;
+  total_weight = 0;
+  total_first = 0;
+  for (size_t s = 0; s < shards.get_shard_count(); s++)
+  {
+    const WordShards::Shard shard = shards.get_shard(s);
+    for (size_t c = 0; c < shard.size; c++)
+    {
+      total_weight += shard.weights[c];
+      total_first += shard.first[c];
+    }
+  }
+  prev_guess.clear();
+}
+
+double ShardedSolver::get_entropy()
+{
+  return total_first / total_weight + std::log2(total_weight);
+}
+
+size_t ShardedSolver::get_word_count()
+{
+  return count;
+}
+
+void ShardedSolver::pick_guesses()
+{
+  /*
+  Small states score every candidate, like Solver. Large ones keep the
+  guess_limit heaviest candidates in a min heap on (weight, -id) and then
+  put them back in dictionary order, so ties go to the earlier word.
+  */
+  guesses.clear();
+  const size_t n = shards.get_word_count();
+  if (count <= guess_limit)
+  {
+    for (size_t id = 0; id < n; id++)
+    {
+      if (live[id / 64] >> (id % 64) & 1)
+        guesses.push_back(id);
+    }
+    return;
+  }
+  auto lighter = [this](const uint32_t a, const uint32_t b)
+  {
+    const double wa = shards.get_weight(a), wb = shards.get_weight(b);
+    return wa != wb ? wa > wb : a < b;
+  };
+  for (size_t id = 0; id < n; id++)
+  {
+    if (!(live[id / 64] >> (id % 64) & 1))
+      continue;
+    if (guesses.size() < guess_limit)
+    {
+      guesses.push_back(id);
+      std::push_heap(guesses.begin(), guesses.end(), lighter);
+    }
+    else if (lighter(id, guesses.front()))
+    {
+      std::pop_heap(guesses.begin(), guesses.end(), lighter);
+      guesses.back() = id;
+      std::push_heap(guesses.begin(), guesses.end(), lighter);
+    }
+  }
+  std::sort(guesses.begin(), guesses.end());
+}
+
+void ShardedSolver::score_blocks(const size_t thread)
+{
+  // threads take whole blocks of guesses and sum every shard in dictionary
+  // order, so scores do not depend on the thread count
+  std::vector<std::pair<double, double>> &hist = thread_hist[thread];
+  std::pair<double, uint32_t> &best = thread_best[thread];
+  best = std::make_pair(std::numeric_limits<double>::max(), UINT32_MAX);
+  char guess_vals[MAX_GUESS_BLOCK][5];
+  const size_t shard_words = shards.get_shard_words();
+  for (size_t g0 = next_block.fetch_add(MAX_GUESS_BLOCK); g0 < guesses.size(); g0 = next_block.fetch_add(MAX_GUESS_BLOCK))
+  {
+    const size_t g1 = std::min(guesses.size(), g0 + MAX_GUESS_BLOCK);
+    std::fill(hist.begin(), hist.begin() + (g1 - g0) * SIZE_OF_RESULTS_SET, std::make_pair(0.0, 0.0));
+    for (size_t g = g0; g < g1; g++)
+    {
+      std::memcpy(guess_vals[g - g0], shards.get_val(guesses[g]), 5);
+    }
+    for (size_t s = 0; s < shards.get_shard_count(); s++)
+    {
+      const WordShards::Shard shard = shards.get_shard(s);
+      const uint64_t *bits = &live[s * shard_words / 64];
+      for (size_t g = g0; g < g1; g++)
+      {
+        std::pair<double, double> *results = &hist[(g - g0) * SIZE_OF_RESULTS_SET];
+        for (size_t c = 0; c < shard.size; c++)
+        {
+          if (!(bits[c / 64] >> (c % 64) & 1))
+            continue;
+          const int i = Solver::word_to_result_index(shard.vals + 5 * c, guess_vals[g - g0]);
+          results[i].first += shard.first[c];
+          results[i].second += shard.weights[c];
+        }
+      }
+    }
+    for (size_t g = g0; g < g1; g++)
+    {
+      // same score as Solver::finish_expect with the linear heuristic
+      const std::pair<double, double> *results = &hist[(g - g0) * SIZE_OF_RESULTS_SET];
+      const double guess_weight = shards.get_weight(guesses[g]);
+      double mean_entropy = 0;
+      for (int i = 0; i < SIZE_OF_RESULTS_SET - 1; i++)
+      {
+        if (results[i].second > 0)
+          mean_entropy += results[i].first + std::log2(results[i].second) * results[i].second;
+      }
+      mean_entropy = std::max(0.0, mean_entropy / (total_weight - guess_weight));
+      const double expect = guess_weight / total_weight + (1 - guess_weight / total_weight) * Solver::heuristic(mean_entropy);
+      // blocks come in dictionary order, so the first of equal scores stays
+      if (expect < best.first)
+        best = std::make_pair(expect, guesses[g]);
+    }
+  }
+}
+
+void ShardedSolver::make_guess(char (&guess)[5])
+{
+  if (prev_guess.empty() && !opening_guess.empty())
+  {
+    // the first guess only depends on the word list, so reuse it
+    prev_guess = opening_guess;
+    std::memcpy(guess, prev_guess.data(), 5);
+    return;
+  }
+  const bool opening = prev_guess.empty();
+  pick_guesses();
+  size_t best_id = guesses.front();
+  if (count > 1)
+  {
+    // wake the pool, take blocks alongside it, and wait for every worker
+    {
+      std::unique_lock<std::mutex> lock(pool_mutex);
+      next_block = 0;
+      pool_done = 0;
+      pool_generation++;
+    }
+    pool_cv.notify_all();
+    score_blocks(0);
+    {
+      std::unique_lock<std::mutex> lock(pool_mutex);
+      master_cv.wait(lock, [this]()
+                     { return pool_done == threads.size(); });
+    }
+    // lowest score, then lowest dictionary index, as Solver picks in word order
+    best_id = std::min_element(thread_best.begin(), thread_best.end())->second;
+  }
+  prev_guess.assign(shards.get_val(best_id), 5);
+  if (opening)
+    opening_guess = prev_guess;
+  std::memcpy(guess, prev_guess.data(), 5);
+}
+
+void ShardedSolver::make_guess(char (&guess)[5], const char (&result)[5])
+{
+  if (prev_guess.size() != 5)
+    throw std::runtime_error("no guess to apply a result to");
+  if (!std::all_of(std::begin(result), std::end(result), [](const char c)
+                   { return c == 'G' || c == 'Y' || c == 'B'; }))
+    throw std::runtime_error("result must be 5 of G, Y, B");
+  // count the survivors first, so a result no candidate gives changes nothing
+  const size_t shard_words = shards.get_shard_words();
+  size_t kept = 0;
+  for (size_t s = 0; s < shards.get_shard_count(); s++)
+  {
+    const WordShards::Shard shard = shards.get_shard(s);
+    const uint64_t *bits = &live[s * shard_words / 64];
+    for (size_t c = 0; c < shard.size; c++)
+    {
+      if ((bits[c / 64] >> (c % 64) & 1) && Solver::word_fits_result(shard.vals + 5 * c, prev_guess.data(), result, {'B', 'Y', 'G'}))
+        kept++;
+    }
+  }
+  if (kept == 0)
+    throw std::runtime_error("no candidate fits " + prev_guess + " " + std::string(result, 5));
+  // the sums are rebuilt over the survivors in order, like Solver::filter_words
+  count = kept;
+  total_weight = 0;
+  total_first = 0;
+  for (size_t s = 0; s < shards.get_shard_count(); s++)
+  {
+    const WordShards::Shard shard = shards.get_shard(s);
+    uint64_t *bits = &live[s * shard_words / 64];
+    for (size_t c = 0; c < shard.size; c++)
+    {
+      if (!(bits[c / 64] >> (c % 64) & 1))
+        continue;
+      if (!Solver::word_fits_result(shard.vals + 5 * c, prev_guess.data(), result, {'B', 'Y', 'G'}))
+      {
+        bits[c / 64] &= ~(1ull << (c % 64));
+        continue;
+      }
+      total_weight += shard.weights[c];
+      total_first += shard.first[c];
+    }
+  }
+  make_guess(guess);
+}
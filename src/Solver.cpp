@@ -1,12 +1,12 @@
 #include "Solver.hpp"
 
-Solver::Word::Word(const std::string &val_, const double weight_)
-    : val(val_), weight(weight_)
+Solver::Word::Word(const std::string &val_, const double weight_, const int id_)
+    : val(val_), weight(weight_), id(id_)
 {
 }
 
 Solver::Word::Word(Word &&rvalue) noexcept
-    : val(std::move(rvalue.val)), weight(std::move(rvalue.weight))
+    : val(std::move(rvalue.val)), weight(std::move(rvalue.weight)), id(rvalue.id)
 {
 }
 
@@ -14,6 +14,7 @@ Solver::Word &Solver::Word::operator=(Word &&rvalue) noexcept
 {
   val = std::move(rvalue.val);
   weight = std::move(rvalue.weight);
+  id = rvalue.id;
   return *this;
 }
 
@@ -27,9 +28,26 @@ const char &Solver::Word::operator[](const unsigned int i) const
   return val[i];
 }
 
+Solver::Scratch::Scratch()
+    : results(SIZE_OF_RESULTS_SET, std::make_pair(0.0, 0.0)), counts(SIZE_OF_RESULTS_SET, 0), vals(nullptr), weights(nullptr)
+{
+}
+
 Solver::Solver(const std::string &data_path)
-    : word_file_path(fs::path(data_path) / fs::path(WORD_WEIGHTS_FILE_NAME))
+    : word_file_path(fs::path(data_path) / fs::path(WORD_WEIGHTS_FILE_NAME)), approx(false),
+      incremental_budget(0), hist_keep(false), hist_valid(false), ranking_k(0)
 {
+  std::ifstream word_file(word_file_path);
+  std::string line;
+  while (std::getline(word_file, line))
+  {
+    if (line.empty())
+      continue;
+    dictionary_index.emplace(line.substr(0, 5), dictionary.size());
+    dictionary.push_back(line.substr(0, 5));
+    dictionary_weights.push_back(std::stod(line.substr(6)));
+    dictionary_live.push_back(true);
+  }
   reset();
 }
 
@@ -37,7 +55,26 @@ Solver::Solver(Solver &&rvalue) noexcept
     : word_file_path(std::move(rvalue.word_file_path))
 {
   words = std::move(rvalue.words);
+  dictionary = std::move(rvalue.dictionary);
+  dictionary_weights = std::move(rvalue.dictionary_weights);
+  dictionary_live = std::move(rvalue.dictionary_live);
+  dictionary_index = std::move(rvalue.dictionary_index);
+  pattern_cache = std::move(rvalue.pattern_cache);
+  scratch = std::move(rvalue.scratch);
+  approx = rvalue.approx;
+  approx_config = rvalue.approx_config;
+  rng = rvalue.rng;
+  incremental_budget = rvalue.incremental_budget;
+  hist_keep = rvalue.hist_keep;
+  hist_valid = rvalue.hist_valid;
+  hist = std::move(rvalue.hist);
+  value_table = std::move(rvalue.value_table);
+  ranking_k = rvalue.ranking_k;
+  top = std::move(rvalue.top);
+  ranking = std::move(rvalue.ranking);
+  opening_ranking = std::move(rvalue.opening_ranking);
   prev_guess = std::move(rvalue.prev_guess);
+  opening_guess = std::move(rvalue.opening_guess);
   total_weight = std::move(rvalue.total_weight);
 }
 
@@ -45,42 +82,176 @@ Solver &Solver::operator=(Solver &&rvalue) noexcept
 {
   word_file_path = std::move(rvalue.word_file_path);
   words = std::move(rvalue.words);
+  dictionary = std::move(rvalue.dictionary);
+  dictionary_weights = std::move(rvalue.dictionary_weights);
+  dictionary_live = std::move(rvalue.dictionary_live);
+  dictionary_index = std::move(rvalue.dictionary_index);
+  pattern_cache = std::move(rvalue.pattern_cache);
+  scratch = std::move(rvalue.scratch);
+  approx = rvalue.approx;
+  approx_config = rvalue.approx_config;
+  rng = rvalue.rng;
+  incremental_budget = rvalue.incremental_budget;
+  hist_keep = rvalue.hist_keep;
+  hist_valid = rvalue.hist_valid;
+  hist = std::move(rvalue.hist);
+  value_table = std::move(rvalue.value_table);
+  ranking_k = rvalue.ranking_k;
+  top = std::move(rvalue.top);
+  ranking = std::move(rvalue.ranking);
+  opening_ranking = std::move(rvalue.opening_ranking);
   prev_guess = std::move(rvalue.prev_guess);
+  opening_guess = std::move(rvalue.opening_guess);
   total_weight = std::move(rvalue.total_weight);
   return *this;
 }
 
 void Solver::reset()
 {
-  std::ifstream word_file(word_file_path);
-  std::string line;
+  prev_guess.clear();
+  hist_valid = false;
+  words.clear();
   total_weight = 0;
-  while (std::getline(word_file, line))
+  for (size_t i = 0; i < dictionary.size(); i++)
   {
-    if (line.empty())
+    if (!dictionary_live[i])
       continue;
-    words.push_back(std::move(Word(line.substr(0, 5), std::stod(line.substr(6)))));
-    total_weight += words.back().weight;
+    words.emplace_back(dictionary[i], dictionary_weights[i], i);
+    total_weight += dictionary_weights[i];
   }
   ASSERT(total_weight, >, 0);
   ASSERT(words.empty(), ==, false);
 }
 
+int Solver::find_word(const std::string &word)
+{
+  const auto it = dictionary_index.find(word);
+  return it == dictionary_index.end() ? -1 : it->second;
+}
+
+void Solver::add_word(const std::string &word, const double weight)
+{
+  if (word.size() != 5 || !std::all_of(word.begin(), word.end(), [](const char c)
+                                        { return c >= 'a' && c <= 'z'; }))
+    throw std::runtime_error("not a 5 letter lowercase word: " + word);
+  if (!(weight > 0))
+    throw std::runtime_error("word weight must be positive");
+  int id = find_word(word);
+  if (id >= 0 && dictionary_live[id])
+    throw std::runtime_error(word + " is already in the dictionary");
+  if (id < 0)
+  {
+    // new words get a new index, so cached rows only need one more entry
+    id = dictionary.size();
+    dictionary_index.emplace(word, id);
+    dictionary.push_back(word);
+    dictionary_weights.push_back(weight);
+    dictionary_live.push_back(false);
+    if (pattern_cache)
+    {
+      for (const int guess : pattern_cache->get_guesses())
+      {
+        pattern_cache->patch(guess, id, word_to_result_index(word, dictionary[guess]));
+      }
+    }
+  }
+  dictionary_live[id] = true;
+  dictionary_weights[id] = weight;
+  opening_guess.clear();
+}
+
+void Solver::remove_word(const std::string &word)
+{
+  const int id = find_word(word);
+  if (id < 0 || !dictionary_live[id])
+    throw std::runtime_error(word + " is not in the dictionary");
+  const auto it = std::find_if(words.begin(), words.end(), [id](const Word &w)
+                               { return w.id == id; });
+  if (it != words.end() && words.size() == 1)
+    throw std::runtime_error(word + " is the last candidate of the current game");
+  // the index stays taken, so cached rows and snapshots keep their meaning
+  dictionary_live[id] = false;
+  opening_guess.clear();
+  if (it != words.end())
+  {
+    total_weight -= it->weight;
+    words.erase(it);
+    hist_valid = false;
+  }
+}
+
+void Solver::set_word_weight(const std::string &word, const double weight)
+{
+  if (!(weight > 0))
+    throw std::runtime_error("word weight must be positive");
+  const int id = find_word(word);
+  if (id < 0 || !dictionary_live[id])
+    throw std::runtime_error(word + " is not in the dictionary");
+  // results do not depend on weights, so cached rows stay valid
+  dictionary_weights[id] = weight;
+  opening_guess.clear();
+  for (auto &w : words)
+  {
+    if (w.id == id)
+    {
+      total_weight += weight - w.weight;
+      w.weight = weight;
+      hist_valid = false;
+    }
+  }
+}
+
 void Solver::make_guess(char (&guess)[5])
 {
+  if (prev_guess.empty() && !opening_guess.empty() && (ranking_k == 0 || !opening_ranking.empty()))
+  {
+    // the first guess only depends on the word list, so reuse it
+    prev_guess = opening_guess;
+    ranking = opening_ranking;
+    for (int i = 0; i < 5; i++)
+    {
+      guess[i] = prev_guess[i];
+    }
+    return;
+  }
+  pack_words();
+  ranking.clear();
+  if (approx && words.size() >= approx_config.min_words)
+  {
+    hist_valid = false;
+    set_guess(words[approx_guess()].val, guess);
+    return;
+  }
   const Word *res = nullptr;
   double best = std::numeric_limits<double>::max();
-  for (const auto &word : words)
+  const size_t block = get_tiling().guesses;
+  double expect[MAX_GUESS_BLOCK];
+  top.clear();
+  for (size_t j = 0; j < words.size(); j += block)
   {
-    double expect = calc_expect(word);
-    if (expect < best)
+    const size_t k = std::min(words.size(), j + block);
+    score_range(j, k, expect, scratch);
+    for (size_t i = j; i < k; i++)
     {
-      best = expect;
-      res = &word;
+      if (expect[i - j] < best)
+      {
+        best = expect[i - j];
+        res = &words[i];
+      }
+      if (ranking_k > 0)
+        push_top(top, ranking_k, expect[i - j], i);
     }
   }
+  hist_valid = hist_keep;
   ASSERT(res, !=, nullptr);
   ASSERT(best, >=, 1);
+  if (ranking_k > 0)
+    finish_ranking(scratch);
+  if (prev_guess.empty())
+  {
+    opening_guess = res->val;
+    opening_ranking = ranking;
+  }
   prev_guess = res->val;
   for (int i = 0; i < 5; i++)
   {
@@ -90,26 +261,141 @@ void Solver::make_guess(char (&guess)[5])
 
 void Solver::make_guess(char (&guess)[5], const char (&result)[5])
 {
-  ASSERT(prev_guess.size(), ==, 5);
-  std::vector<Word> temp;
-  temp.reserve(words.size() / 2);
-  // update from result
-  total_weight = 0;
-  for (auto &word : words)
+  check_result(result);
+  filter_words(result);
+  make_guess(guess);
+}
+
+void Solver::apply_result(const std::string &guess, const char (&result)[5])
+{
+  if (guess.size() != 5 || !std::all_of(guess.begin(), guess.end(), [](const char c)
+                                         { return c >= 'a' && c <= 'z'; }))
+    throw std::runtime_error("not a 5 letter lowercase word: " + guess);
+  // filter_words reads the guess from prev_guess
+  const std::string played = prev_guess;
+  prev_guess = guess;
+  try
+  {
+    check_result(result);
+    filter_words(result);
+  }
+  catch (const std::exception &)
+  {
+    prev_guess = played;
+    throw;
+  }
+}
+
+void Solver::check_result(const char (&result)[5])
+{
+  if (prev_guess.size() != 5)
+    throw std::runtime_error("no guess to apply a result to");
+  if (!std::all_of(std::begin(result), std::end(result), [](const char c)
+                   { return c == 'G' || c == 'Y' || c == 'B'; }))
+    throw std::runtime_error("result must be 5 of G, Y, B");
+}
+
+void Solver::filter_words(const char (&result)[5])
+{
+  // compact in place so a move never allocates
+  keep_mask.resize(words.size());
+  size_t n = 0;
+  double min_weight = std::numeric_limits<double>::max();
+  double kept_weight = 0;
+  for (size_t i = 0; i < words.size(); i++)
   {
-    if (word_fits_result(word.val, prev_guess, result, {'B', 'Y', 'G'}))
+    keep_mask[i] = word_fits_result(words[i].val, prev_guess, result, {'B', 'Y', 'G'});
+    if (keep_mask[i])
     {
-      total_weight += word.weight;
-      temp.push_back(std::move(word));
+      kept_weight += words[i].weight;
+      min_weight = std::min(min_weight, words[i].weight);
+      n++;
     }
   }
+  // nothing has changed yet, so a result no candidate gives leaves the game as it was
+  if (n == 0)
+    throw std::runtime_error("no candidate fits " + prev_guess + " " + std::string(result, 5));
+  total_weight = kept_weight;
+  if (hist_valid)
+    update_histograms(n, min_weight);
+  n = 0;
+  for (size_t i = 0; i < words.size(); i++)
+  {
+    if (keep_mask[i])
+    {
+      if (n != i)
+      {
+        words[n] = std::move(words[i]);
+        if (hist_valid)
+          std::copy(hist.begin() + i * SIZE_OF_RESULTS_SET, hist.begin() + (i + 1) * SIZE_OF_RESULTS_SET, hist.begin() + n * SIZE_OF_RESULTS_SET);
+      }
+      n++;
+    }
+  }
+  words.erase(words.begin() + n, words.end());
+  if (hist_valid)
+    hist.resize(n * SIZE_OF_RESULTS_SET);
   ASSERT(total_weight, >, 0);
-  words = std::move(temp);
   ASSERT(words.empty(), ==, false);
-  make_guess(guess);
 }
 
-double Solver::calc_expect(const Solver::Word &guess)
+void Solver::update_histograms(const size_t kept, const double min_weight)
+{
+  /*
+  The survivors are one bucket of the last guess, so every surviving
+  guess's histogram only loses the removed words. Subtracting costs
+  kept * removed pairs and a rebuild costs kept * kept, so subtract when
+  fewer words were removed than kept, otherwise let the next move rebuild.
+  Subtracting leaves rounding in the sums, so small states, where close
+  scores decide the game and a rebuild is cheap, are always rebuilt.
+  */
+  const size_t removed = words.size() - kept;
+  if (removed < kept && kept >= INCREMENTAL_MIN_WORDS)
+    subtract_removed(min_weight);
+  else
+    hist_valid = false;
+}
+
+void Solver::subtract_removed(const double min_weight)
+{
+  subtract_range(0, words.size(), min_weight);
+}
+
+void Solver::subtract_range(const size_t first, const size_t last, const double min_weight)
+{
+  for (size_t g = first; g < last; g++)
+  {
+    if (!keep_mask[g])
+      continue;
+    std::pair<double, double> *results = &hist[g * SIZE_OF_RESULTS_SET];
+    for (size_t w = 0; w < words.size(); w++)
+    {
+      if (keep_mask[w])
+        continue;
+      const int i = word_to_result_index(words[w], words[g]);
+      results[i].first += words[w].weight * std::log2(words[w].weight);
+      results[i].second -= words[w].weight;
+      // a non-empty bucket weighs at least min_weight, so this is rounding
+      if (results[i].second < min_weight / 2)
+        results[i] = std::make_pair(0.0, 0.0);
+    }
+  }
+}
+
+void Solver::enable_incremental(const size_t budget_bytes)
+{
+  incremental_budget = budget_bytes;
+  hist_valid = false;
+}
+
+void Solver::disable_incremental()
+{
+  incremental_budget = 0;
+  hist_valid = false;
+  decltype(hist)().swap(hist);
+}
+
+double Solver::calc_expect(const Solver::Word &guess, Scratch &arena)
 {
   if (words.size() <= 1)
     return 1;
@@ -121,152 +407,574 @@ double Solver::calc_expect(const Solver::Word &guess)
   first = - SUM_{w in W} w_weight * log2(w_weight)
   second = r_weight
   */
-  std::vector<std::pair<double, double>> results;
-  results.reserve(SIZE_OF_RESULTS_SET);
-  for (int i = 0; i < SIZE_OF_RESULTS_SET; i++)
-  {
-    results.push_back(std::make_pair(0, 0));
-  }
+  std::vector<std::pair<double, double>> &results = arena.results;
+  std::vector<int> &counts = arena.counts;
+  std::fill(results.begin(), results.end(), std::make_pair(0.0, 0.0));
+  std::fill(counts.begin(), counts.end(), 0);
+  if (pattern_cache && words.size() >= PATTERN_CACHE_MIN_WORDS && read_row(guess, arena))
+    return sum_row(guess, arena);
   for (const auto &word : words)
   {
 
     const int i = word_to_result_index(word, guess);
     results[i].first -= word.weight * std::log2(word.weight);
     results[i].second += word.weight;
+    counts[i]++;
   }
-  // skip all greens (SIZE_OF_RESULTS_SET - 1)
-  results.pop_back();
+  return finish_expect(results.data(), counts.data(), guess.weight, total_weight);
+}
+
+bool Solver::read_row(const Solver::Word &guess, Scratch &arena)
+{
   /*
-  R = set of all results
-  t = total weight of words without all greens
-  mean_entropy = SUM_{r in R} r_weight * r_entropy / t
+  Cached rows are read only at the candidates left. A missing row is built
+  and stored while the state is a large part of the dictionary; smaller
+  states are scored without it, since a whole row costs more than they do.
   */
-  double mean_entropy = 0;
-  for (const auto &result : results)
+  const size_t n = words.size();
+  std::vector<int> &ids = arena.ids;
+  ids.resize(n);
+  for (size_t j = 0; j < n; j++)
+  {
+    ids[j] = words[j].id;
+  }
+  arena.slice.resize(n);
+  if (pattern_cache->lookup(guess.id, ids.data(), n, arena.slice.data()))
+    return true;
+  if (n * PATTERN_CACHE_MIN_FRACTION < dictionary.size())
+    return false;
+  std::vector<uint8_t> &row = arena.row;
+  row.resize(dictionary.size());
+  for (size_t j = 0; j < dictionary.size(); j++)
   {
-    if (result.second > 0)
+    row[j] = word_to_result_index(dictionary[j], guess);
+  }
+  pattern_cache->insert(guess.id, row);
+  for (size_t j = 0; j < n; j++)
+  {
+    arena.slice[j] = row[ids[j]];
+  }
+  return true;
+}
+
+double Solver::sum_row(const Solver::Word &guess, Scratch &arena)
+{
+  // packed weights already hold -w log2 w, so the sums match score_block
+  const std::pair<double, double> *weights = arena.weights ? arena.weights : packed_weights.data();
+  ASSERT(packed_weights.size(), ==, words.size());
+  std::vector<std::pair<double, double>> &results = arena.results;
+  std::vector<int> &counts = arena.counts;
+  std::fill(results.begin(), results.end(), std::make_pair(0.0, 0.0));
+  std::fill(counts.begin(), counts.end(), 0);
+  for (size_t j = 0; j < words.size(); j++)
+  {
+    const int i = arena.slice[j];
+    results[i].first += weights[j].first;
+    results[i].second += weights[j].second;
+    counts[i]++;
+  }
+  return finish_expect(results.data(), counts.data(), guess.weight, total_weight);
+}
+
+const Solver::Tiling &Solver::get_tiling()
+{
+  static const Tiling tiling = []()
+  {
+    long l1 = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+    long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (l1 <= 0)
+      l1 = DEFAULT_L1_CACHE_SIZE;
+    if (l2 <= 0)
+      l2 = DEFAULT_L2_CACHE_SIZE;
+    // use half of each level, leaving room for everything else
+    Tiling t;
+    t.guesses = std::clamp<size_t>(l2 / 2 / (SIZE_OF_RESULTS_SET * sizeof(std::pair<double, double>)), 1, MAX_GUESS_BLOCK);
+    t.candidates = std::clamp<size_t>(l1 / 2 / (5 + sizeof(std::pair<double, double>)), 64, 1 << 16);
+    return t;
+  }();
+  return tiling;
+}
+
+void Solver::pack_words()
+{
+  hist_keep = !value_table && words.size() > 1 && words.size() * SIZE_OF_RESULTS_SET * sizeof(std::pair<double, double>) <= incremental_budget;
+  if (hist_keep && !hist_valid)
+    hist.resize(words.size() * SIZE_OF_RESULTS_SET);
+  packed_vals.resize(5 * words.size());
+  packed_weights.resize(words.size());
+  for (size_t j = 0; j < words.size(); j++)
+  {
+    std::copy(words[j].val.begin(), words[j].val.begin() + 5, packed_vals.begin() + 5 * j);
+    packed_weights[j] = std::make_pair(-words[j].weight * std::log2(words[j].weight), words[j].weight);
+  }
+}
+
+void Solver::score_range(const size_t first, const size_t last, double *out, Scratch &arena)
+{
+  if (hist_keep && hist_valid)
+  {
+    // carried over from the last move
+    for (size_t g = first; g < last; g++)
     {
-      mean_entropy += result.first + std::log2(result.second) * result.second;
+      out[g - first] = finish_expect(&hist[g * SIZE_OF_RESULTS_SET], nullptr, words[g].weight, total_weight);
+    }
+    return;
+  }
+  if (!hist_keep && pattern_cache && !prev_guess.empty() && words.size() > 1 && words.size() >= PATTERN_CACHE_MIN_WORDS)
+  {
+    // the opening is scored once per word list, so its rows would mostly
+    // be evicted before any reuse and it goes straight to score_block
+    for (size_t j = first; j < last; j++)
+    {
+      if (read_row(words[j], arena))
+        out[j - first] = sum_row(words[j], arena);
+      else
+        score_block(j, j + 1, out + (j - first), arena);
+    }
+    return;
+  }
+  score_block(first, last, out, arena);
+}
+
+void Solver::score_block(const size_t first, const size_t last, double *out, Scratch &arena)
+{
+  /*
+  Same sums as calc_expect, but tiled. A block of guesses keeps its
+  histograms in L2 while each tile of candidates stays in L1, so the
+  candidates are read from memory once per block instead of once per guess.
+  Each bucket still sums candidates in word order, so scores match
+  calc_expect exactly. With incremental scoring on, each guess's histogram
+  is built in hist instead so the next move can reuse it.
+  */
+  const size_t n = words.size();
+  if (n <= 1)
+  {
+    std::fill(out, out + (last - first), 1.0);
+    return;
+  }
+  const Tiling &tiling = get_tiling();
+  const char *vals = arena.vals ? arena.vals : packed_vals.data();
+  const std::pair<double, double> *weights = arena.weights ? arena.weights : packed_weights.data();
+  arena.block.resize(tiling.guesses * SIZE_OF_RESULTS_SET);
+  arena.block_counts.resize(tiling.guesses * SIZE_OF_RESULTS_SET);
+  for (size_t g0 = first; g0 < last; g0 += tiling.guesses)
+  {
+    const size_t g1 = std::min(last, g0 + tiling.guesses);
+    std::pair<double, double> *block = hist_keep ? &hist[g0 * SIZE_OF_RESULTS_SET] : arena.block.data();
+    std::fill(block, block + (g1 - g0) * SIZE_OF_RESULTS_SET, std::make_pair(0.0, 0.0));
+    std::fill(arena.block_counts.begin(), arena.block_counts.begin() + (g1 - g0) * SIZE_OF_RESULTS_SET, 0);
+    for (size_t c0 = 0; c0 < n; c0 += tiling.candidates)
+    {
+      const size_t c1 = std::min(n, c0 + tiling.candidates);
+      for (size_t g = g0; g < g1; g++)
+      {
+        std::pair<double, double> *results = &block[(g - g0) * SIZE_OF_RESULTS_SET];
+        int *counts = &arena.block_counts[(g - g0) * SIZE_OF_RESULTS_SET];
+        const char *guess = &vals[5 * g];
+        for (size_t c = c0; c < c1; c++)
+        {
+          const int i = word_to_result_index(&vals[5 * c], guess);
+          results[i].first += weights[c].first;
+          results[i].second += weights[c].second;
+          counts[i]++;
+        }
+      }
+    }
+    for (size_t g = g0; g < g1; g++)
+    {
+      ASSERT(total_weight, >, words[g].weight);
+      out[g - first] = finish_expect(&block[(g - g0) * SIZE_OF_RESULTS_SET], &arena.block_counts[(g - g0) * SIZE_OF_RESULTS_SET], words[g].weight, total_weight);
     }
   }
-  mean_entropy /= total_weight - guess.weight;
-  ASSERT(mean_entropy, >=, 0);
-  ASSERT(std::isnan(mean_entropy), ==, false);
-  return guess.weight / total_weight + (1 - guess.weight / total_weight) * heuristic(mean_entropy);
 }
 
-inline double Solver::heuristic(const double entropy)
+void Solver::set_guess(const std::string &val, char (&guess)[5])
 {
-  // a straight line between (0, 1) and (11.5, 3.5)
-  // simple regression on assumption that 11.5 bits of entropy requires about 3.5 guesses
-  return 0.217391304347826 * entropy + 1;
+  if (prev_guess.empty())
+    opening_guess = val;
+  prev_guess = val;
+  for (int i = 0; i < 5; i++)
+  {
+    guess[i] = prev_guess[i];
+  }
 }
 
-double Solver::get_entropy()
+void Solver::enable_approx(const ApproxConfig &config)
+{
+  approx = true;
+  approx_config = config;
+  approx_config.initial_sample = std::max<size_t>(approx_config.initial_sample, 2);
+  approx_config.finalists = std::max<size_t>(approx_config.finalists, 1);
+  rng.seed(config.seed);
+}
+
+void Solver::disable_approx()
+{
+  approx = false;
+}
+
+size_t Solver::approx_guess()
 {
   /*
-  W = set of possible words left
-  t = total weight of possible words
-  entropy = - SUM_{w in W} w_weight * log2(w_weight) / t + log2(t)
+  Draw m candidates with probability w / t. For a guess g and a sampled
+  word s that is not g, with R the result s gets,
+    v_s = log2(W_R) - log2(w_s)
+  averages to the mean entropy calc_expect computes. W_R is estimated by
+  t * (samples in R) / m. The standard error of the mean of v gives an
+  interval on the score. Each round drops guesses whose lower bound is
+  above the best upper bound and keeps at most the better half of the
+  rest, then doubles m. Finalists are scored exactly.
   */
-  double entropy = 0;
-  for (const auto &word : words)
+  const size_t n = words.size();
+  std::vector<double> &cumulative = scratch.cumulative;
+  std::vector<size_t> &sample = scratch.sample;
+  std::vector<size_t> &alive = scratch.alive;
+  std::vector<size_t> &order = scratch.order;
+  std::vector<size_t> &survivors = scratch.survivors;
+  std::vector<double> &estimate = scratch.estimate;
+  std::vector<std::pair<double, double>> &bounds = scratch.bounds;
+  cumulative.resize(n);
+  double sum = 0;
+  for (size_t j = 0; j < n; j++)
   {
-    if (word.weight > 0)
+    sum += words[j].weight;
+    cumulative[j] = sum;
+  }
+  alive.resize(n);
+  for (size_t j = 0; j < n; j++)
+  {
+    alive[j] = j;
+  }
+  std::uniform_real_distribution<double> uniform(0, sum);
+  for (size_t m = approx_config.initial_sample; alive.size() > approx_config.finalists && m < n; m *= 2)
+  {
+    sample.resize(m);
+    for (auto &s : sample)
     {
-      entropy -= word.weight * std::log2(word.weight);
+      s = std::min<size_t>(std::upper_bound(cumulative.begin(), cumulative.end(), uniform(rng)) - cumulative.begin(), n - 1);
     }
+    bounds.resize(alive.size());
+    estimate.resize(alive.size());
+    approx_round();
+    double best_upper = std::numeric_limits<double>::max();
+    for (const auto &bound : bounds)
+    {
+      best_upper = std::min(best_upper, bound.second);
+    }
+    // order by estimate, dropping guesses that are clearly worse
+    order.resize(alive.size());
+    for (size_t a = 0; a < order.size(); a++)
+    {
+      order[a] = a;
+    }
+    std::stable_sort(order.begin(), order.end(), [&estimate](const size_t x, const size_t y)
+                     { return estimate[x] < estimate[y]; });
+    const size_t keep = std::max(approx_config.finalists, (alive.size() + 1) / 2);
+    survivors.clear();
+    for (const size_t a : order)
+    {
+      if (survivors.size() >= keep)
+        break;
+      if (bounds[a].first <= best_upper)
+        survivors.push_back(alive[a]);
+    }
+    // keep word order so exact ties break the same way as make_guess
+    std::sort(survivors.begin(), survivors.end());
+    alive.swap(survivors);
   }
-  return entropy / total_weight + std::log2(total_weight);
+  size_t res = alive[0];
+  double best = std::numeric_limits<double>::max();
+  for (const size_t j : alive)
+  {
+    const double expect = calc_expect(words[j], scratch);
+    if (expect < best)
+    {
+      best = expect;
+      res = j;
+    }
+  }
+  return res;
 }
 
-template <typename T, typename U, typename V>
-inline bool Solver::word_fits_result(const T &word, const U &guessed, const V &result, const char (&code)[3])
+void Solver::approx_round()
 {
-  bool used[5];
-  // 0=Gray, 1=Yellow, 2=Green
-  for (int i = 0; i < 5; i++)
+  approx_range(0, scratch.alive.size(), scratch);
+}
+
+void Solver::approx_range(const size_t first, const size_t last, Scratch &arena)
+{
+  // the round's sample and survivors are in the solver's scratch, and each
+  // range fills its own estimates and bounds there
+  const std::vector<size_t> &sample = scratch.sample;
+  const size_t m = sample.size();
+  const double sum = scratch.cumulative.back();
+  std::vector<uint8_t> &patterns = arena.patterns;
+  patterns.resize(m);
+  for (size_t a = first; a < last; a++)
   {
-    if (result[i] == code[1] && guessed[i] == word[i])
+    const size_t g = scratch.alive[a];
+    const char *guess = &packed_vals[5 * g];
+    int count[SIZE_OF_RESULTS_SET] = {0};
+    for (size_t i = 0; i < m; i++)
     {
-      return false;
+      patterns[i] = word_to_result_index(&packed_vals[5 * sample[i]], guess);
+      count[patterns[i]]++;
     }
-    else if (result[i] == code[2])
+    double mean = 0, sq = 0;
+    int k = 0;
+    for (size_t i = 0; i < m; i++)
     {
-      if (guessed[i] != word[i])
-        return false;
-      used[i] = true;
+      const int r = patterns[i];
+      if (r == SIZE_OF_RESULTS_SET - 1)
+        continue;
+      const double v = std::log2(sum * count[r] / m) - std::log2(words[sample[i]].weight);
+      mean += v;
+      sq += v * v;
+      k++;
+    }
+    const double p = words[g].weight / sum;
+    if (k == 0)
+    {
+      // every sample was the guess itself
+      scratch.estimate[a] = p + (1 - p) * heuristic(0);
+      scratch.bounds[a] = std::make_pair(scratch.estimate[a], scratch.estimate[a]);
     }
     else
     {
-      used[i] = false;
+      mean /= k;
+      const double se = k > 1 ? std::sqrt(std::max(0.0, sq / k - mean * mean) / (k - 1)) : std::numeric_limits<double>::infinity();
+      const double half = approx_config.z * se;
+      scratch.estimate[a] = p + (1 - p) * heuristic(mean);
+      scratch.bounds[a] = std::make_pair(p + (1 - p) * heuristic(std::max(0.0, mean - half)), p + (1 - p) * heuristic(mean + half));
     }
   }
-  for (int i = 0; i < 5; i++)
+}
+
+double Solver::calc_expect(const Solver::Word &guess, const std::vector<int> &subset, const double subset_weight, Scratch &arena)
+{
+  if (subset.size() <= 1)
+    return 1;
+  ASSERT(subset_weight, >, guess.weight);
+  std::vector<std::pair<double, double>> &results = arena.results;
+  std::vector<int> &counts = arena.counts;
+  std::fill(results.begin(), results.end(), std::make_pair(0.0, 0.0));
+  std::fill(counts.begin(), counts.end(), 0);
+  for (const int j : subset)
   {
-    if (result[i] == code[0])
+    const Word &word = words[j];
+    const int i = word_to_result_index(word, guess);
+    results[i].first -= word.weight * std::log2(word.weight);
+    results[i].second += word.weight;
+    counts[i]++;
+  }
+  return finish_expect(results.data(), counts.data(), guess.weight, subset_weight);
+}
+
+double Solver::finish_expect(const std::pair<double, double> *results, const int *counts, const double guess_weight, const double weight)
+{
+  if (value_table && counts)
+  {
+    /*
+    score = p + SUM_{r in R} r_weight / t * (1 + V(r_count, r_entropy))
+    with V read from the fitted table instead of one line through the
+    mean entropy
+    */
+    double expect = guess_weight / weight;
+    for (int i = 0; i < SIZE_OF_RESULTS_SET - 1; i++)
     {
-      for (int j = 0; j < 5; j++)
+      if (counts[i] > 0)
       {
-        if (!used[j] && guessed[i] == word[j])
-          return false;
+        const double entropy = std::max(0.0, results[i].first / results[i].second + std::log2(results[i].second));
+        expect += results[i].second / weight * (1 + value_table->query(counts[i], entropy));
       }
     }
-    else if (result[i] == code[1])
+    ASSERT(std::isnan(expect), ==, false);
+    return expect;
+  }
+  /*
+  R = set of all results
+  t = total weight of words without all greens
+  mean_entropy = SUM_{r in R} r_weight * r_entropy / t
+  */
+  double mean_entropy = 0;
+  // skip all greens (SIZE_OF_RESULTS_SET - 1)
+  for (int i = 0; i < SIZE_OF_RESULTS_SET - 1; i++)
+  {
+    if (results[i].second > 0)
     {
-      bool flag = true;
-      for (int j = 0; j < 5; j++)
-      {
-        if (!used[j] && guessed[i] == word[j])
-        {
-          used[j] = true;
-          flag = false;
-          break;
-        }
-      }
-      if (flag)
-        return false;
+      mean_entropy += results[i].first + std::log2(results[i].second) * results[i].second;
     }
   }
-  return true;
+  // incrementally updated histograms can round a zero entropy below 0
+  mean_entropy = std::max(0.0, mean_entropy / (weight - guess_weight));
+  ASSERT(mean_entropy, >=, 0);
+  ASSERT(std::isnan(mean_entropy), ==, false);
+  return guess_weight / weight + (1 - guess_weight / weight) * heuristic(mean_entropy);
+}
+
+void Solver::load_value_table(const std::string &path)
+{
+  value_table = std::make_shared<const ValueTable>(path);
+  hist_valid = false;
+  // the opening was scored with the old heuristic
+  opening_guess.clear();
+}
+
+int Solver::get_word_count()
+{
+  return words.size();
+}
+
+void Solver::enable_ranking(const size_t k)
+{
+  ranking_k = k;
+  top.reserve(k + 1);
+  ranking.reserve(k);
+  opening_ranking.clear();
+}
+
+void Solver::disable_ranking()
+{
+  ranking_k = 0;
+  ranking.clear();
+  opening_ranking.clear();
+}
+
+const std::vector<Solver::RankedGuess> &Solver::get_ranking()
+{
+  return ranking;
+}
+
+void Solver::push_top(std::vector<std::pair<double, int>> &top_, const size_t k, const double score, const int index)
+{
+  // max heap on (score, index), so the root is the one to drop next and
+  // ties go to the earlier word like the argmin does
+  const std::pair<double, int> entry(score, index);
+  if (top_.size() < k)
+  {
+    top_.push_back(entry);
+    std::push_heap(top_.begin(), top_.end());
+  }
+  else if (entry < top_.front())
+  {
+    std::pop_heap(top_.begin(), top_.end());
+    top_.back() = entry;
+    std::push_heap(top_.begin(), top_.end());
+  }
 }
 
-template <typename T, typename U>
-inline int Solver::word_to_result_index(const T &word, const U &guessed)
+void Solver::finish_ranking(Scratch &arena)
 {
-  bool word_used[5], guess_used[5];
-  // 0=Gray, 1=Yellow, 2=Green
-  int result = 0;
-  for (int i = 0, radix = 1; i < 5; i++, radix *= 3)
+  /*
+  Only the survivors need their partitions, so the statistics cost k
+  passes over the candidates on top of the scan.
+  */
+  std::sort_heap(top.begin(), top.end());
+  ranking.resize(top.size());
+  for (size_t t = 0; t < top.size(); t++)
   {
-    if (guessed[i] == word[i])
+    const Word &guess = words[top[t].second];
+    std::vector<std::pair<double, double>> &results = arena.results;
+    std::vector<int> &counts = arena.counts;
+    std::fill(results.begin(), results.end(), std::make_pair(0.0, 0.0));
+    std::fill(counts.begin(), counts.end(), 0);
+    for (const auto &word : words)
     {
-      result += 2 * radix;
-      word_used[i] = true;
-      guess_used[i] = true;
+      const int i = word_to_result_index(word, guess);
+      results[i].second += word.weight;
+      counts[i]++;
     }
-    else
+    RankedGuess &ranked = ranking[t];
+    ranked.word = guess.val;
+    ranked.score = top[t].first;
+    ranked.bucket_count = 0;
+    ranked.largest_bucket = 0;
+    ranked.entropy = 0;
+    for (int i = 0; i < SIZE_OF_RESULTS_SET; i++)
     {
-      word_used[i] = false;
-      guess_used[i] = false;
+      if (counts[i] == 0)
+        continue;
+      const double p = results[i].second / total_weight;
+      ranked.bucket_count++;
+      ranked.largest_bucket = std::max(ranked.largest_bucket, counts[i]);
+      ranked.entropy -= p * std::log2(p);
     }
   }
-  for (int i = 0, radix = 1; i < 5; i++, radix *= 3)
+  top.clear();
+}
+
+std::string Solver::get_opening_guess()
+{
+  return opening_guess;
+}
+
+void Solver::set_opening_guess(const std::string &guess)
+{
+  if (guess.size() != 5)
+    throw std::runtime_error("opening guess must be 5 letters");
+  opening_guess = guess;
+}
+
+void Solver::save_snapshot(Snapshot &snapshot)
+{
+  snapshot.ids.resize(words.size());
+  snapshot.weights.resize(words.size());
+  for (size_t i = 0; i < words.size(); i++)
   {
-    if (!guess_used[i])
+    snapshot.ids[i] = words[i].id;
+    snapshot.weights[i] = words[i].weight;
+  }
+  snapshot.prev_guess = prev_guess;
+}
+
+void Solver::restore_snapshot(const Snapshot &snapshot)
+{
+  ASSERT(snapshot.ids.size(), ==, snapshot.weights.size());
+  ASSERT(snapshot.ids.empty(), ==, false);
+  words.clear();
+  total_weight = 0;
+  for (size_t i = 0; i < snapshot.ids.size(); i++)
+  {
+    ASSERT(snapshot.ids[i], <, (int)dictionary.size());
+    words.emplace_back(dictionary[snapshot.ids[i]], snapshot.weights[i], snapshot.ids[i]);
+    total_weight += snapshot.weights[i];
+  }
+  prev_guess = snapshot.prev_guess;
+  // carried histograms belong to the state being left
+  hist_valid = false;
+}
+
+void Solver::enable_pattern_cache(const size_t budget_bytes)
+{
+  pattern_cache = std::make_shared<PatternCache>(budget_bytes);
+}
+
+void Solver::enable_pattern_cache(const std::shared_ptr<PatternCache> &cache)
+{
+  pattern_cache = cache;
+}
+
+std::shared_ptr<PatternCache> Solver::get_pattern_cache()
+{
+  return pattern_cache;
+}
+
+double Solver::get_entropy()
+{
+  /*
+  W = set of possible words left
+  t = total weight of possible words
+  entropy = - SUM_{w in W} w_weight * log2(w_weight) / t + log2(t)
+  */
+  double entropy = 0;
+  for (const auto &word : words)
+  {
+    if (word.weight > 0)
     {
-      for (int j = 0; j < 5; j++)
-      {
-        if (!word_used[j] && guessed[i] == word[j])
-        {
-          result += radix;
-          word_used[j] = true;
-          break;
-        }
-      }
+      entropy -= word.weight * std::log2(word.weight);
     }
   }
-  return result;
+  return entropy / total_weight + std::log2(total_weight);
 }
 
 SolverParallel::SolverParallel(const std::string &data_path)
@@ -274,14 +982,35 @@ SolverParallel::SolverParallel(const std::string &data_path)
 {
   std::unique_lock<std::mutex> lock(pool_mutex);
   terminate_pool = false;
+  pool_task = POOL_SCORE;
+  pool_min_weight = 0;
+  speculate = false;
+  speculation_budget = 0;
+  spec_next = 0;
+  spec_active = 0;
+  spec_hits = 0;
+  spec_cancel = false;
   int num_threads = std::max(1u, std::thread::hardware_concurrency());
   thread_done_count = 0;
+  pinned_count = 0;
+  pack_count = 0;
+  if (Topology::get().get_node_count() > 1)
+  {
+    for (int node = 0; node < Topology::get().get_node_count(); node++)
+    {
+      replicas.push_back(std::make_unique<NodeReplica>());
+      replicas.back()->version = 0;
+    }
+  }
   threads.reserve(num_threads);
   thread_status.reserve(num_threads);
   thread_args = std::vector<std::pair<int, int>>(num_threads);
   thread_ret = std::vector<std::vector<double>>(num_threads);
+  thread_top = std::vector<std::vector<std::pair<double, int>>>(num_threads);
+  thread_scratch = std::vector<Scratch>(num_threads);
   for (int i = 0; i < num_threads; i++)
   {
+    thread_ret[i].reserve((words.size() + num_threads - 1) / num_threads);
     thread_status.push_back(false);
     threads.push_back(std::thread(thread_start_routine, this, i));
   }
@@ -292,14 +1021,46 @@ SolverParallel::SolverParallel(SolverParallel &&rvalue) noexcept
   std::unique_lock<std::mutex> lock(pool_mutex);
   word_file_path = std::move(rvalue.word_file_path);
   words = std::move(rvalue.words);
+  dictionary = std::move(rvalue.dictionary);
+  dictionary_weights = std::move(rvalue.dictionary_weights);
+  dictionary_live = std::move(rvalue.dictionary_live);
+  dictionary_index = std::move(rvalue.dictionary_index);
+  pattern_cache = std::move(rvalue.pattern_cache);
+  scratch = std::move(rvalue.scratch);
+  approx = rvalue.approx;
+  approx_config = rvalue.approx_config;
+  rng = rvalue.rng;
+  incremental_budget = rvalue.incremental_budget;
+  hist_keep = rvalue.hist_keep;
+  hist_valid = rvalue.hist_valid;
+  hist = std::move(rvalue.hist);
+  value_table = std::move(rvalue.value_table);
+  ranking_k = rvalue.ranking_k;
+  top = std::move(rvalue.top);
+  ranking = std::move(rvalue.ranking);
+  opening_ranking = std::move(rvalue.opening_ranking);
   prev_guess = std::move(rvalue.prev_guess);
+  opening_guess = std::move(rvalue.opening_guess);
   total_weight = rvalue.total_weight;
   terminate_pool = rvalue.terminate_pool;
+  pool_task = POOL_SCORE;
+  pool_min_weight = 0;
+  speculate = rvalue.speculate;
+  speculation_budget = rvalue.speculation_budget;
+  spec_next = 0;
+  spec_active = 0;
+  spec_hits = rvalue.spec_hits;
+  spec_cancel = false;
   int num_threads = rvalue.threads.size();
   thread_args = std::move(rvalue.thread_args);
   thread_ret = std::move(rvalue.thread_ret);
+  thread_top = std::move(rvalue.thread_top);
+  thread_scratch = std::move(rvalue.thread_scratch);
+  replicas = std::move(rvalue.replicas);
+  pack_count = rvalue.pack_count;
   delete &rvalue;
   thread_done_count = 0;
+  pinned_count = 0;
   threads.reserve(num_threads);
   thread_status.reserve(num_threads);
   for (int i = 0; i < num_threads; i++)
@@ -314,14 +1075,46 @@ SolverParallel &SolverParallel::operator=(SolverParallel &&rvalue) noexcept
   std::unique_lock<std::mutex> lock(pool_mutex);
   word_file_path = std::move(rvalue.word_file_path);
   words = std::move(rvalue.words);
+  dictionary = std::move(rvalue.dictionary);
+  dictionary_weights = std::move(rvalue.dictionary_weights);
+  dictionary_live = std::move(rvalue.dictionary_live);
+  dictionary_index = std::move(rvalue.dictionary_index);
+  pattern_cache = std::move(rvalue.pattern_cache);
+  scratch = std::move(rvalue.scratch);
+  approx = rvalue.approx;
+  approx_config = rvalue.approx_config;
+  rng = rvalue.rng;
+  incremental_budget = rvalue.incremental_budget;
+  hist_keep = rvalue.hist_keep;
+  hist_valid = rvalue.hist_valid;
+  hist = std::move(rvalue.hist);
+  value_table = std::move(rvalue.value_table);
+  ranking_k = rvalue.ranking_k;
+  top = std::move(rvalue.top);
+  ranking = std::move(rvalue.ranking);
+  opening_ranking = std::move(rvalue.opening_ranking);
   prev_guess = std::move(rvalue.prev_guess);
+  opening_guess = std::move(rvalue.opening_guess);
   total_weight = rvalue.total_weight;
   terminate_pool = rvalue.terminate_pool;
+  pool_task = POOL_SCORE;
+  pool_min_weight = 0;
+  speculate = rvalue.speculate;
+  speculation_budget = rvalue.speculation_budget;
+  spec_next = 0;
+  spec_active = 0;
+  spec_hits = rvalue.spec_hits;
+  spec_cancel = false;
   int num_threads = rvalue.threads.size();
   thread_args = std::move(rvalue.thread_args);
   thread_ret = std::move(rvalue.thread_ret);
+  thread_top = std::move(rvalue.thread_top);
+  thread_scratch = std::move(rvalue.thread_scratch);
+  replicas = std::move(rvalue.replicas);
+  pack_count = rvalue.pack_count;
   delete &rvalue;
   thread_done_count = 0;
+  pinned_count = 0;
   threads.reserve(num_threads);
   thread_status.reserve(num_threads);
   for (int i = 0; i < num_threads; i++)
@@ -334,6 +1127,7 @@ SolverParallel &SolverParallel::operator=(SolverParallel &&rvalue) noexcept
 
 SolverParallel::~SolverParallel()
 {
+  cancel_speculation();
   {
     std::unique_lock<std::mutex> lock(pool_mutex);
     terminate_pool = true;
@@ -346,17 +1140,84 @@ SolverParallel::~SolverParallel()
   threads.clear();
   thread_args.clear();
   thread_ret.clear();
+  thread_top.clear();
+  thread_scratch.clear();
   thread_status.clear();
 }
 
+void SolverParallel::reset()
+{
+  cancel_speculation();
+  Solver::reset();
+}
+
+void SolverParallel::restore_snapshot(const Snapshot &snapshot)
+{
+  cancel_speculation();
+  Solver::restore_snapshot(snapshot);
+}
+
+void SolverParallel::add_word(const std::string &word, const double weight)
+{
+  cancel_speculation();
+  Solver::add_word(word, weight);
+}
+
+void SolverParallel::remove_word(const std::string &word)
+{
+  cancel_speculation();
+  Solver::remove_word(word);
+}
+
+void SolverParallel::set_word_weight(const std::string &word, const double weight)
+{
+  cancel_speculation();
+  Solver::set_word_weight(word, weight);
+}
+
+void SolverParallel::apply_result(const std::string &guess, const char (&result)[5])
+{
+  cancel_speculation();
+  Solver::apply_result(guess, result);
+}
+
+void SolverParallel::load_value_table(const std::string &path)
+{
+  cancel_speculation();
+  Solver::load_value_table(path);
+}
+
 void SolverParallel::make_guess(char (&guess)[5])
 {
+  cancel_speculation();
+  if (prev_guess.empty() && !opening_guess.empty() && (ranking_k == 0 || !opening_ranking.empty()))
+  {
+    prev_guess = opening_guess;
+    ranking = opening_ranking;
+    for (int i = 0; i < 5; i++)
+    {
+      guess[i] = prev_guess[i];
+    }
+    start_speculation();
+    return;
+  }
+  pack_words();
+  pack_count++;
+  ranking.clear();
+  if (approx && words.size() >= approx_config.min_words)
+  {
+    hist_valid = false;
+    set_guess(words[approx_guess()].val, guess);
+    start_speculation();
+    return;
+  }
   const Word *res = nullptr;
   double best = std::numeric_limits<double>::max();
   int words_per_thread = (words.size() + threads.size() - 1) / threads.size();
   ASSERT(threads.size(), ==, thread_args.size());
   ASSERT(thread_args.size(), ==, thread_status.size());
   ASSERT(thread_ret.size(), ==, thread_args.size());
+  top.clear();
   {
     std::unique_lock<std::mutex> lock1(pool_mutex);
     for (size_t i = 0; i < thread_args.size(); i++)
@@ -383,74 +1244,310 @@ void SolverParallel::make_guess(char (&guess)[5])
         for (size_t k = 0; k < thread_ret[j].size(); k++)
         {
           ASSERT(std::isnan(thread_ret[j][k]), ==, false);
-          if (thread_ret[j][k] < best)
+          // workers finish in any order, so equal scores go to the earlier word as in Solver
+          if (thread_ret[j][k] < best || (thread_ret[j][k] == best && &words[k + thread_args[j].first] < res))
           {
             best = thread_ret[j][k];
             res = &words[k + thread_args[j].first];
           }
         }
         thread_ret[j].clear();
+        // merge this thread's best into the move's
+        for (const auto &entry : thread_top[j])
+        {
+          push_top(top, ranking_k, entry.first, entry.second);
+        }
+        thread_top[j].clear();
         break;
       }
     }
   }
+  hist_valid = hist_keep;
   ASSERT(best, >=, 1);
   ASSERT(res, !=, nullptr);
+  if (ranking_k > 0)
+    finish_ranking(scratch);
+  if (prev_guess.empty())
+  {
+    opening_guess = res->val;
+    opening_ranking = ranking;
+  }
   prev_guess = res->val;
   for (int i = 0; i < 5; i++)
   {
     guess[i] = prev_guess[i];
   }
+  start_speculation();
 }
 
 void SolverParallel::make_guess(char (&guess)[5], const char (&result)[5])
 {
-  ASSERT(prev_guess.size(), ==, 5);
-  // update from result
-  std::vector<Word> temp;
-  temp.reserve(words.size() / 2);
-  total_weight = 0;
-  for (auto &word : words)
+  check_result(result);
+  std::string hit;
   {
-    if (word_fits_result(word.val, prev_guess, result, {'B', 'Y', 'G'}))
+    const int r = result_to_index(result);
+    std::unique_lock<std::mutex> lock(pool_mutex);
+    if (speculate && ranking_k == 0 && !spec_guesses.empty())
+      hit = std::move(spec_guesses[r]);
+  }
+  // words is about to be filtered, so no worker may still be reading it
+  cancel_speculation();
+  filter_words(result);
+  if (hit.empty())
+  {
+    make_guess(guess);
+    return;
+  }
+  spec_hits++;
+  prev_guess = std::move(hit);
+  for (int i = 0; i < 5; i++)
+  {
+    guess[i] = prev_guess[i];
+  }
+  start_speculation();
+}
+
+void SolverParallel::subtract_removed(const double min_weight)
+{
+  {
+    std::unique_lock<std::mutex> lock(pool_mutex);
+    pool_min_weight = min_weight;
+  }
+  run_pool(POOL_SUBTRACT, words.size());
+}
+
+void SolverParallel::approx_round()
+{
+  run_pool(POOL_APPROX, scratch.alive.size());
+}
+
+void SolverParallel::run_pool(const PoolTask task, const size_t count)
+{
+  // each worker takes its own share of the guesses and the master waits for all
+  const size_t per_thread = (count + threads.size() - 1) / threads.size();
+  {
+    std::unique_lock<std::mutex> lock1(pool_mutex);
+    pool_task = task;
+    for (size_t i = 0; i < thread_args.size(); i++)
     {
-      total_weight += word.weight;
-      temp.push_back(std::move(word));
+      thread_args[i] = std::make_pair(std::min(i * per_thread, count), std::min((i + 1) * per_thread, count));
+      thread_status[i] = true;
     }
   }
-  ASSERT(total_weight, >, 0);
-  words = std::move(temp);
-  ASSERT(words.empty(), ==, false);
-  make_guess(guess);
+  pool_cv.notify_all();
+  {
+    std::unique_lock<std::mutex> lock_master(master_mutex);
+    master_cv.wait(lock_master, [this]()
+                   { return thread_done_count >= (int)threads.size(); });
+    thread_done_count -= threads.size();
+  }
+  std::unique_lock<std::mutex> lock2(pool_mutex);
+  pool_task = POOL_SCORE;
+}
+
+void SolverParallel::enable_speculation(const size_t budget_bytes)
+{
+  cancel_speculation();
+  std::unique_lock<std::mutex> lock(pool_mutex);
+  speculate = true;
+  speculation_budget = budget_bytes;
+}
+
+void SolverParallel::disable_speculation()
+{
+  cancel_speculation();
+  std::unique_lock<std::mutex> lock(pool_mutex);
+  speculate = false;
+}
+
+void SolverParallel::cancel_speculation()
+{
+  std::unique_lock<std::mutex> lock(pool_mutex);
+  spec_cancel = true;
+  spec_queue.clear();
+  spec_next = 0;
+  spec_cv.wait(lock, [this]()
+               { return spec_active == 0; });
+  spec_buckets.clear();
+  spec_weights.clear();
+  spec_guesses.clear();
+}
+
+int SolverParallel::get_speculation_hits()
+{
+  return spec_hits;
+}
+
+int SolverParallel::get_pinned_count()
+{
+  return pinned_count;
+}
+
+int SolverParallel::get_replica_count()
+{
+  return replicas.size();
+}
+
+void SolverParallel::bind_replica(const int i, Scratch &arena)
+{
+  if (replicas.empty())
+    return;
+  /*
+  Pages are placed on the node of the thread that first touches them, so
+  the copy is made by a worker of the node that reads it. The master wrote
+  packed_vals and bumped pack_count before handing out the move under
+  pool_mutex, so both are current here.
+  */
+  NodeReplica &replica = *replicas[Topology::get().get_worker_node(i)];
+  {
+    std::unique_lock<std::mutex> lock(replica.mutex);
+    if (replica.version != pack_count)
+    {
+      replica.vals.assign(packed_vals.begin(), packed_vals.end());
+      replica.weights.assign(packed_weights.begin(), packed_weights.end());
+      replica.version = pack_count;
+    }
+  }
+  arena.vals = replica.vals.data();
+  arena.weights = replica.weights.data();
+}
+
+void SolverParallel::start_speculation()
+{
+  if (!speculate || prev_guess.size() != 5)
+    return;
+  /*
+  Split the candidates by the result prev_guess would get, then queue the
+  heaviest buckets first since those are the likeliest results. Buckets are
+  queued until the index lists and stored guesses would exceed the budget.
+  */
+  std::vector<std::vector<int>> buckets(SIZE_OF_RESULTS_SET);
+  std::vector<double> weights(SIZE_OF_RESULTS_SET, 0);
+  for (size_t j = 0; j < words.size(); j++)
+  {
+    const int r = word_to_result_index(words[j], prev_guess);
+    buckets[r].push_back(j);
+    weights[r] += words[j].weight;
+  }
+  std::vector<int> queue;
+  queue.reserve(SIZE_OF_RESULTS_SET - 1);
+  // skip all greens (SIZE_OF_RESULTS_SET - 1)
+  for (int r = 0; r < SIZE_OF_RESULTS_SET - 1; r++)
+  {
+    if (!buckets[r].empty())
+      queue.push_back(r);
+  }
+  std::stable_sort(queue.begin(), queue.end(), [&weights](const int a, const int b)
+                   { return weights[a] > weights[b]; });
+  size_t used = 0, n = 0;
+  for (; n < queue.size(); n++)
+  {
+    const size_t cost = buckets[queue[n]].size() * sizeof(int) + sizeof(std::vector<int>) + sizeof(std::string);
+    if (used + cost > speculation_budget)
+      break;
+    used += cost;
+  }
+  queue.resize(n);
+  for (int r = 0; r < SIZE_OF_RESULTS_SET; r++)
+  {
+    if (std::find(queue.begin(), queue.end(), r) == queue.end())
+      std::vector<int>().swap(buckets[r]);
+  }
+  {
+    std::unique_lock<std::mutex> lock(pool_mutex);
+    spec_buckets = std::move(buckets);
+    spec_weights = std::move(weights);
+    spec_guesses = std::vector<std::string>(SIZE_OF_RESULTS_SET);
+    spec_queue = std::move(queue);
+    spec_next = 0;
+    spec_cancel = false;
+  }
+  pool_cv.notify_all();
+}
+
+void SolverParallel::run_speculation(const int r, Scratch &arena)
+{
+  const std::vector<int> &bucket = spec_buckets[r];
+  const double weight = spec_weights[r];
+  const Word *res = nullptr;
+  double best = std::numeric_limits<double>::max();
+  for (const int j : bucket)
+  {
+    if (spec_cancel)
+      return;
+    double expect = calc_expect(words[j], bucket, weight, arena);
+    if (expect < best)
+    {
+      best = expect;
+      res = &words[j];
+    }
+  }
+  ASSERT(res, !=, nullptr);
+  std::unique_lock<std::mutex> lock(pool_mutex);
+  if (!spec_cancel)
+    spec_guesses[r] = res->val;
 }
 
 void SolverParallel::thread_start_routine(SolverParallel *solver, const int i)
 {
   int j, k;
+  PoolTask task;
+  double min_weight;
+  if (Topology::pin_current_thread(Topology::get().get_worker_cpu(i)))
+    solver->pinned_count++;
   while (true)
   {
     {
       std::unique_lock<std::mutex> lock1(solver->pool_mutex);
       ASSERT(i, <, (int)solver->thread_status.size());
       solver->pool_cv.wait(lock1, [&]()
-                           { return solver->thread_status[i] || solver->terminate_pool; });
+                           { return solver->thread_status[i] || solver->terminate_pool || (!solver->spec_cancel && solver->spec_next < solver->spec_queue.size()); });
       if (solver->terminate_pool)
         return;
+      if (!solver->thread_status[i])
+      {
+        // idle, so take the next speculative bucket
+        const int r = solver->spec_queue[solver->spec_next++];
+        solver->spec_active++;
+        lock1.unlock();
+        solver->run_speculation(r, solver->thread_scratch[i]);
+        lock1.lock();
+        solver->spec_active--;
+        if (solver->spec_active == 0)
+          solver->spec_cv.notify_all();
+        continue;
+      }
       ASSERT(i, <, (int)solver->thread_args.size());
       j = solver->thread_args[i].first;
       k = solver->thread_args[i].second;
+      task = solver->pool_task;
+      min_weight = solver->pool_min_weight;
     }
     ASSERT(j, <=, k);
-    std::vector<double> ret;
-    ret.reserve(k - j);
-    for (; j < k; j++)
+    if (task == POOL_SUBTRACT)
+      solver->subtract_range(j, k, min_weight);
+    else if (task == POOL_APPROX)
+      solver->approx_range(j, k, solver->thread_scratch[i]);
+    // the master only reads thread_ret[i] once thread_status[i] is false,
+    // so it is filled in place and keeps its capacity between moves
+    std::vector<double> &ret = solver->thread_ret[i];
+    ASSERT(k, <=, (int)solver->words.size());
+    if (task == POOL_SCORE)
+    {
+      ret.resize(k - j);
+      solver->bind_replica(i, solver->thread_scratch[i]);
+      solver->score_range(j, k, ret.data(), solver->thread_scratch[i]);
+    }
+    if (task == POOL_SCORE && solver->ranking_k > 0)
     {
-      ASSERT(j, <, (int)solver->words.size());
-      ret.push_back(solver->calc_expect(solver->words[j]));
+      std::vector<std::pair<double, int>> &heap = solver->thread_top[i];
+      for (int g = j; g < k; g++)
+      {
+        push_top(heap, solver->ranking_k, ret[g - j], g);
+      }
     }
     {
       std::unique_lock<std::mutex> lock2(solver->pool_mutex);
-      solver->thread_ret[i] = std::move(ret);
       solver->thread_status[i] = false;
     }
     {
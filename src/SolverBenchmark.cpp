@@ -0,0 +1,136 @@
+#include "SolverBenchmark.hpp"
+
+#ifndef CHRONO_H
+#define CHRONO_H
+#include <chrono>
+namespace chrono = std::chrono;
+#endif
+
+/* Times each per word kernel is run, since one run is over in microseconds */
+#define BENCHMARK_WORD_KERNEL_RUNS 16
+
+SolverBenchmark::SolverBenchmark(const std::string &data_path)
+    : Solver(data_path)
+{
+}
+
+template <typename F>
+void SolverBenchmark::measure(PerfCounters &counters, Sample &sample, F &&run)
+{
+  if (sample.counts.empty())
+    sample.counts.assign(counters.get_events().size(), 0);
+  counters.read(before);
+  const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  run();
+  const chrono::steady_clock::time_point stop = chrono::steady_clock::now();
+  counters.read(after);
+  sample.ms += chrono::duration<double, std::milli>(stop - start).count();
+  sample.calls++;
+  for (size_t i = 0; i < sample.counts.size(); i++)
+  {
+    if (before[i] < 0 || after[i] < 0 || sample.counts[i] < 0)
+      sample.counts[i] = -1;
+    else
+      sample.counts[i] += after[i] - before[i];
+  }
+}
+
+std::vector<SolverBenchmark::Sample> SolverBenchmark::run_kernels(PerfCounters &counters, Adversary &adversary, const size_t guesses)
+{
+  reset();
+  pack_words();
+  const size_t n = words.size();
+  const size_t g1 = std::max<size_t>(1, std::min(guesses, n));
+  std::vector<double> out(g1);
+  std::vector<Sample> samples;
+  const auto add = [&](const std::string &name, const long long pairs)
+  {
+    samples.push_back({name, 0, pairs, 0, {}});
+    return &samples.back();
+  };
+
+  Sample *sample = add("calc_expect", g1 * n);
+  measure(counters, *sample, [&]()
+          {
+            for (size_t g = 0; g < g1; g++)
+            {
+              out[g] = calc_expect(words[g], scratch);
+            } });
+
+  sample = add("score_block", g1 * n);
+  measure(counters, *sample, [&]()
+          { score_block(0, g1, out.data(), scratch); });
+
+  // warm a cache big enough for every row, then time the lookups only
+  const std::shared_ptr<PatternCache> saved_cache = pattern_cache;
+  pattern_cache = std::make_shared<PatternCache>(2 * g1 * dictionary.size() + (1 << 20));
+  for (size_t g = 0; g < g1; g++)
+  {
+    out[g] = calc_expect(words[g], scratch);
+  }
+  sample = add("cached rows", g1 * n);
+  measure(counters, *sample, [&]()
+          {
+            for (size_t g = 0; g < g1; g++)
+            {
+              out[g] = calc_expect(words[g], scratch);
+            } });
+  pattern_cache = saved_cache;
+
+  sample = add("pack_words", BENCHMARK_WORD_KERNEL_RUNS * n);
+  for (int r = 0; r < BENCHMARK_WORD_KERNEL_RUNS; r++)
+  {
+    measure(counters, *sample, [&]()
+            { pack_words(); });
+  }
+
+  // filter by the first guess against a word from the middle of the list
+  char guess[5], res[5];
+  std::copy(words[0].val.begin(), words[0].val.begin() + 5, guess);
+  adversary.set_target_word(words[n / 2].val);
+  adversary.judge(guess, res);
+  Snapshot snapshot;
+  save_snapshot(snapshot);
+  sample = add("filter_words", BENCHMARK_WORD_KERNEL_RUNS * n);
+  for (int r = 0; r < BENCHMARK_WORD_KERNEL_RUNS; r++)
+  {
+    restore_snapshot(snapshot);
+    prev_guess = words[0].val;
+    measure(counters, *sample, [&]()
+            { filter_words(res); });
+  }
+  reset();
+  return samples;
+}
+
+std::vector<SolverBenchmark::Sample> SolverBenchmark::run_games(PerfCounters &counters, Adversary &adversary, const std::vector<std::string> &targets)
+{
+  std::vector<Sample> stages;
+  char word[5], res[5];
+  for (const auto &target : targets)
+  {
+    adversary.set_target_word(target);
+    reset();
+    std::fill(std::begin(res), std::end(res), 'B');
+    for (size_t stage = 0; std::count(std::begin(res), std::end(res), 'G') < 5; stage++)
+    {
+      if (stage >= MAX_GUESSES)
+        throw std::runtime_error("no solution for " + target);
+      if (stage >= stages.size())
+        stages.push_back({"move " + std::to_string(stage + 1), 0, 0, 0, {}});
+      // the cached opening scores nothing, and later moves score every
+      // candidate left after filtering against every other
+      const bool scores = stage > 0 || opening_guess.empty();
+      if (stage == 0)
+        measure(counters, stages[stage], [&]()
+                { make_guess(word); });
+      else
+        measure(counters, stages[stage], [&]()
+                { make_guess(word, res); });
+      if (scores)
+        stages[stage].pairs += (long long)words.size() * words.size();
+      adversary.judge(word, res);
+    }
+  }
+  return stages;
+}
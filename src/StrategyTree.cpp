@@ -0,0 +1,185 @@
+#include "StrategyTree.hpp"
+
+#ifndef ADVERSARY_HPP
+#define ADVERSARY_HPP
+#include "Adversary.hpp"
+#endif
+
+#ifndef SOLVER_HPP
+#define SOLVER_HPP
+#include "Solver.hpp"
+#endif
+
+#ifndef CSTRING_H
+#define CSTRING_H
+#include <cstring>
+#endif
+
+#ifndef FCNTL_H
+#define FCNTL_H
+#include <fcntl.h>
+#endif
+
+#ifndef UNISTD_H
+#define UNISTD_H
+#include <unistd.h>
+#endif
+
+#ifndef SYS_MMAN_H
+#define SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+#ifndef SYS_STAT_H
+#define SYS_STAT_H
+#include <sys/stat.h>
+#endif
+
+#define STRATEGY_TREE_MAGIC "WDLT"
+#define STRATEGY_TREE_VERSION 1
+
+StrategyTree::StrategyTree(const std::string &tree_path)
+    : map(MAP_FAILED), map_size(0), nodes(nullptr), node_count(0), cur(0)
+{
+  const int fd = open(tree_path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("cannot open " + tree_path);
+  struct stat st;
+  if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(Header))
+  {
+    close(fd);
+    throw std::runtime_error("bad strategy tree " + tree_path);
+  }
+  map_size = st.st_size;
+  map = mmap(nullptr, map_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+    throw std::runtime_error("cannot map " + tree_path);
+  const Header *header = static_cast<const Header *>(map);
+  if (std::memcmp(header->magic, STRATEGY_TREE_MAGIC, 4) != 0 || header->version != STRATEGY_TREE_VERSION || header->node_count == 0 || map_size != sizeof(Header) + header->node_count * sizeof(Node))
+  {
+    unmap();
+    throw std::runtime_error("bad strategy tree " + tree_path);
+  }
+  node_count = header->node_count;
+  nodes = reinterpret_cast<const Node *>(header + 1);
+}
+
+StrategyTree::StrategyTree(StrategyTree &&rvalue) noexcept
+    : map(rvalue.map), map_size(rvalue.map_size), nodes(rvalue.nodes), node_count(rvalue.node_count), cur(rvalue.cur)
+{
+  rvalue.map = MAP_FAILED;
+  rvalue.nodes = nullptr;
+}
+
+StrategyTree &StrategyTree::operator=(StrategyTree &&rvalue) noexcept
+{
+  unmap();
+  map = rvalue.map;
+  map_size = rvalue.map_size;
+  nodes = rvalue.nodes;
+  node_count = rvalue.node_count;
+  cur = rvalue.cur;
+  rvalue.map = MAP_FAILED;
+  rvalue.nodes = nullptr;
+  return *this;
+}
+
+StrategyTree::~StrategyTree()
+{
+  unmap();
+}
+
+void StrategyTree::unmap()
+{
+  if (map != MAP_FAILED)
+    munmap(map, map_size);
+  map = MAP_FAILED;
+  nodes = nullptr;
+}
+
+void StrategyTree::reset()
+{
+  cur = 0;
+}
+
+void StrategyTree::make_guess(char (&guess)[5])
+{
+  cur = 0;
+  std::memcpy(guess, nodes[cur].guess, 5);
+}
+
+void StrategyTree::make_guess(char (&guess)[5], const char (&result)[5])
+{
+  const uint32_t next = nodes[cur].child[Solver::result_to_index(result)];
+  if (next == 0)
+    throw std::runtime_error("result is not in the strategy tree");
+  cur = next;
+  std::memcpy(guess, nodes[cur].guess, 5);
+}
+
+double StrategyTree::get_entropy()
+{
+  return nodes[cur].entropy;
+}
+
+size_t StrategyTree::get_node_count()
+{
+  return node_count;
+}
+
+size_t StrategyTree::compile(const std::string &data_path, const std::string &tree_path)
+{
+  Solver solver(data_path);
+  Adversary adversary(data_path);
+  std::vector<Node> tree(1);
+  std::memset(&tree[0], 0, sizeof(Node));
+  tree[0].entropy = solver.get_entropy();
+  char word[5], res[5];
+  for (const auto &target : Adversary::load_target_words(data_path))
+  {
+    adversary.set_target_word(target);
+    uint32_t node = 0;
+    int num_guesses = 1;
+    solver.make_guess(word);
+    std::memcpy(tree[node].guess, word, 5);
+    adversary.judge(word, res);
+    while (std::count(std::begin(res), std::end(res), 'G') < 5)
+    {
+      if (++num_guesses > MAX_GUESSES)
+        throw std::runtime_error("no solution for " + target);
+      const int r = Solver::result_to_index(res);
+      if (tree[node].child[r] == 0)
+      {
+        tree[node].child[r] = tree.size();
+        tree.emplace_back();
+        std::memset(&tree.back(), 0, sizeof(Node));
+      }
+      node = tree[node].child[r];
+      solver.make_guess(word, res);
+      // the policy is deterministic, so a revisited node makes the same guess
+      ASSERT(tree[node].guess[0] == '\0' || std::memcmp(tree[node].guess, word, 5) == 0, ==, true);
+      std::memcpy(tree[node].guess, word, 5);
+      tree[node].entropy = solver.get_entropy();
+      adversary.judge(word, res);
+    }
+    solver.reset();
+  }
+
+  // write next to the destination then rename so readers never see half a file
+  Header header;
+  std::memcpy(header.magic, STRATEGY_TREE_MAGIC, 4);
+  header.version = STRATEGY_TREE_VERSION;
+  header.node_count = tree.size();
+  header.reserved = 0;
+  const std::string temp_path = tree_path + ".tmp";
+  {
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(tree.data()), tree.size() * sizeof(Node));
+    if (!out)
+      throw std::runtime_error("cannot write " + temp_path);
+  }
+  fs::rename(temp_path, tree_path);
+  return tree.size();
+}
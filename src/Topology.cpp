@@ -0,0 +1,206 @@
+#include "Topology.hpp"
+
+#ifndef SCHED_H
+#define SCHED_H
+#include <sched.h>
+#endif
+
+#ifndef PTHREAD_H
+#define PTHREAD_H
+#include <pthread.h>
+#endif
+
+#ifndef SYS_MMAN_H
+#define SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+#ifndef STDINT_H
+#define STDINT_H
+#include <stdint.h>
+#endif
+
+#ifndef FSTREAM_H
+#define FSTREAM_H
+#include <fstream>
+#endif
+
+#ifndef SSTREAM_H
+#define SSTREAM_H
+#include <sstream>
+#endif
+
+#ifndef ALGORITHM_H
+#define ALGORITHM_H
+#include <algorithm>
+#endif
+
+#ifndef FILESYSTEM_H
+#define FILESYSTEM_H
+#include <filesystem>
+namespace fs = std::filesystem;
+#endif
+
+#define NODE_SYSFS_PATH "/sys/devices/system/node"
+#define HUGE_PAGE_SYSFS_PATH "/sys/kernel/mm/transparent_hugepage/enabled"
+
+namespace
+{
+  // parses a sysfs CPU list such as "0-3,8-11"
+  std::vector<int> parse_cpu_list(const std::string &list)
+  {
+    std::vector<int> cpus;
+    std::istringstream in(list);
+    std::string range;
+    while (std::getline(in, range, ','))
+    {
+      int first, last;
+      const size_t dash = range.find('-');
+      try
+      {
+        first = std::stoi(range.substr(0, dash));
+        last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+      }
+      catch (const std::exception &)
+      {
+        continue;
+      }
+      for (int cpu = first; cpu <= last; cpu++)
+      {
+        cpus.push_back(cpu);
+      }
+    }
+    return cpus;
+  }
+}
+
+Topology::Topology()
+    : node_count(1)
+{
+  std::vector<int> allowed;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0)
+  {
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+    {
+      if (CPU_ISSET(cpu, &set))
+        allowed.push_back(cpu);
+    }
+  }
+  if (allowed.empty())
+    allowed.push_back(0);
+
+  // allowed CPUs of each node, skipping nodes with memory only
+  std::vector<std::pair<int, std::vector<int>>> nodes;
+  std::error_code ec;
+  for (const auto &entry : fs::directory_iterator(NODE_SYSFS_PATH, ec))
+  {
+    const std::string name = entry.path().filename().string();
+    if (name.size() <= 4 || name.compare(0, 4, "node") != 0 || name.find_first_not_of("0123456789", 4) != std::string::npos)
+      continue;
+    std::ifstream file(entry.path() / "cpulist");
+    std::string list;
+    std::getline(file, list);
+    std::vector<int> node_cpus;
+    for (const int cpu : parse_cpu_list(list))
+    {
+      if (std::binary_search(allowed.begin(), allowed.end(), cpu))
+        node_cpus.push_back(cpu);
+    }
+    if (!node_cpus.empty())
+      nodes.push_back(std::make_pair(std::stoi(name.substr(4)), node_cpus));
+  }
+  if (nodes.empty())
+    nodes.push_back(std::make_pair(0, allowed));
+  std::sort(nodes.begin(), nodes.end());
+  node_count = nodes.size();
+
+  // deal CPUs round robin across nodes
+  for (size_t k = 0; cpus.size() < allowed.size(); k++)
+  {
+    bool any = false;
+    for (size_t node = 0; node < nodes.size(); node++)
+    {
+      if (k < nodes[node].second.size())
+      {
+        cpus.push_back(nodes[node].second[k]);
+        cpu_nodes.push_back(node);
+        any = true;
+      }
+    }
+    if (!any)
+      break;
+  }
+}
+
+const Topology &Topology::get()
+{
+  static const Topology topology;
+  return topology;
+}
+
+int Topology::get_node_count() const
+{
+  return node_count;
+}
+
+int Topology::get_cpu_count() const
+{
+  return cpus.size();
+}
+
+int Topology::get_worker_cpu(const int worker) const
+{
+  return cpus[worker % cpus.size()];
+}
+
+int Topology::get_worker_node(const int worker) const
+{
+  return cpu_nodes[worker % cpu_nodes.size()];
+}
+
+bool Topology::pin_current_thread(const int cpu)
+{
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+std::string Topology::get_huge_page_mode()
+{
+  // the active mode is in brackets, as in "always [madvise] never"
+  std::ifstream file(HUGE_PAGE_SYSFS_PATH);
+  std::string line;
+  std::getline(file, line);
+  const size_t open = line.find('['), close = line.find(']');
+  if (open == std::string::npos || close == std::string::npos || close < open)
+    return "unknown";
+  return line.substr(open + 1, close - open - 1);
+}
+
+void *Topology::alloc_huge(const size_t bytes)
+{
+  const size_t size = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+  void *p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (p != MAP_FAILED)
+    return p;
+  // no reserved huge pages, so map one extra and trim to an aligned range
+  // the kernel can back with transparent huge pages
+  char *raw = static_cast<char *>(mmap(nullptr, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  if (raw == MAP_FAILED)
+    throw std::bad_alloc();
+  char *aligned = reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(raw) + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE);
+  if (aligned > raw)
+    munmap(raw, aligned - raw);
+  if (aligned + size < raw + size + HUGE_PAGE_SIZE)
+    munmap(aligned + size, raw + size + HUGE_PAGE_SIZE - (aligned + size));
+  madvise(aligned, size, MADV_HUGEPAGE);
+  return aligned;
+}
+
+void Topology::free_huge(void *p, const size_t bytes)
+{
+  munmap(p, (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE);
+}
@@ -0,0 +1,152 @@
+#include "ValueTable.hpp"
+
+#ifndef MATH_H
+#define MATH_H
+#include <math.h>
+#endif
+
+#ifndef FSTREAM_H
+#define FSTREAM_H
+#include <fstream>
+#endif
+
+#ifndef SSTREAM_H
+#define SSTREAM_H
+#include <sstream>
+#endif
+
+#ifndef ALGORITHM_H
+#define ALGORITHM_H
+#include <algorithm>
+#endif
+
+#ifndef STDEXCEPT_H
+#define STDEXCEPT_H
+#include <stdexcept>
+#endif
+
+#ifndef FILESYSTEM_H
+#define FILESYSTEM_H
+#include <filesystem>
+namespace fs = std::filesystem;
+#endif
+
+ValueTable::ValueTable(const int count_bins_, const int entropy_bins_, const double entropy_step_)
+    : count_bins(count_bins_), entropy_bins(entropy_bins_), entropy_step(entropy_step_),
+      values(count_bins_ * entropy_bins_, 0), sums(count_bins_ * entropy_bins_, 0), samples(count_bins_ * entropy_bins_, 0)
+{
+}
+
+ValueTable::ValueTable(const std::string &path)
+{
+  std::ifstream file(path);
+  if (!file)
+    throw std::runtime_error("cannot open " + path);
+  std::string line;
+  while (std::getline(file, line) && (line.empty() || line[0] == '#'))
+    ;
+  std::istringstream header(line);
+  if (!(header >> count_bins >> entropy_bins >> entropy_step) || count_bins < 2 || entropy_bins < 2 || entropy_step <= 0)
+    throw std::runtime_error("bad value table " + path);
+  values.resize(count_bins * entropy_bins);
+  for (auto &value : values)
+  {
+    if (!(file >> value))
+      throw std::runtime_error("bad value table " + path);
+  }
+}
+
+double &ValueTable::cell(const int c, const int e)
+{
+  return values[c * entropy_bins + e];
+}
+
+double ValueTable::cell(const int c, const int e) const
+{
+  return values[c * entropy_bins + e];
+}
+
+double ValueTable::query(const int count, const double entropy) const
+{
+  if (count <= 1)
+    return 1;
+  const double x = std::min<double>(std::log2(count), count_bins - 1);
+  const double y = std::min<double>(std::max(0.0, entropy / entropy_step), entropy_bins - 1);
+  const int c = std::min<int>(x, count_bins - 2);
+  const int e = std::min<int>(y, entropy_bins - 2);
+  const double dx = x - c;
+  const double dy = y - e;
+  const double low = cell(c, e) * (1 - dy) + cell(c, e + 1) * dy;
+  const double high = cell(c + 1, e) * (1 - dy) + cell(c + 1, e + 1) * dy;
+  return std::max(1.0, low * (1 - dx) + high * dx);
+}
+
+void ValueTable::add_sample(const int count, const double entropy, const int guesses)
+{
+  const int c = std::min<int>(std::lround(std::log2(std::max(count, 1))), count_bins - 1);
+  const int e = std::min<int>(std::lround(std::max(0.0, entropy / entropy_step)), entropy_bins - 1);
+  sums[c * entropy_bins + e] += guesses;
+  samples[c * entropy_bins + e]++;
+}
+
+void ValueTable::fit()
+{
+  /*
+  Cells with samples hold their mean. Empty cells, which the policy never
+  visits but scoring still asks about, come from a least squares line of
+  guesses against entropy through every sample, so they keep growing with
+  entropy instead of flattening out.
+  */
+  double n = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+  for (int c = 0; c < count_bins; c++)
+  {
+    for (int e = 0; e < entropy_bins; e++)
+    {
+      const double x = e * entropy_step;
+      const int k = samples[c * entropy_bins + e];
+      const double y = sums[c * entropy_bins + e];
+      n += k;
+      sx += k * x;
+      sy += y;
+      sxx += k * x * x;
+      sxy += x * y;
+    }
+  }
+  double slope = 0, intercept = 1;
+  if (n > 1 && n * sxx - sx * sx > 0)
+  {
+    slope = (n * sxy - sx * sy) / (n * sxx - sx * sx);
+    intercept = (sy - slope * sx) / n;
+  }
+  for (int c = 0; c < count_bins; c++)
+  {
+    for (int e = 0; e < entropy_bins; e++)
+    {
+      const int k = samples[c * entropy_bins + e];
+      cell(c, e) = k > 0 ? sums[c * entropy_bins + e] / k : std::max(1.0, intercept + slope * e * entropy_step);
+    }
+  }
+}
+
+void ValueTable::save(const std::string &path) const
+{
+  const std::string temp_path = path + ".tmp";
+  {
+    std::ofstream file(temp_path, std::ios::trunc);
+    file << "# expected guesses to solve a state\n"
+         << "# rows: round(log2(candidates)), columns: round(entropy / step)\n"
+         << count_bins << ' ' << entropy_bins << ' ' << entropy_step << '\n';
+    file.precision(6);
+    for (int c = 0; c < count_bins; c++)
+    {
+      for (int e = 0; e < entropy_bins; e++)
+      {
+        file << (e ? " " : "") << cell(c, e);
+      }
+      file << '\n';
+    }
+    if (!file)
+      throw std::runtime_error("cannot write " + temp_path);
+  }
+  fs::rename(temp_path, path);
+}
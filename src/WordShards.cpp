@@ -0,0 +1,196 @@
+#include "WordShards.hpp"
+
+#ifndef MATH_H
+#define MATH_H
+#include <math.h>
+#endif
+
+#ifndef CSTRING_H
+#define CSTRING_H
+#include <cstring>
+#endif
+
+#ifndef VECTOR_H
+#define VECTOR_H
+#include <vector>
+#endif
+
+#ifndef ALGORITHM_H
+#define ALGORITHM_H
+#include <algorithm>
+#endif
+
+#ifndef FSTREAM_H
+#define FSTREAM_H
+#include <fstream>
+#endif
+
+#ifndef FILESYSTEM_H
+#define FILESYSTEM_H
+#include <filesystem>
+namespace fs = std::filesystem;
+#endif
+
+#ifndef FCNTL_H
+#define FCNTL_H
+#include <fcntl.h>
+#endif
+
+#ifndef UNISTD_H
+#define UNISTD_H
+#include <unistd.h>
+#endif
+
+#ifndef SYS_MMAN_H
+#define SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+#ifndef SYS_STAT_H
+#define SYS_STAT_H
+#include <sys/stat.h>
+#endif
+
+#define WORD_SHARDS_MAGIC "WDLS"
+#define WORD_SHARDS_VERSION 1
+
+WordShards::WordShards(const std::string &shards_path)
+    : map(MAP_FAILED), map_size(0), base(nullptr), shard_words(0), shard_count(0), word_count(0)
+{
+  const int fd = open(shards_path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("cannot open " + shards_path);
+  struct stat st;
+  if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(Header))
+  {
+    close(fd);
+    throw std::runtime_error("bad word shards " + shards_path);
+  }
+  map_size = st.st_size;
+  map = mmap(nullptr, map_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+    throw std::runtime_error("cannot map " + shards_path);
+  const Header *header = static_cast<const Header *>(map);
+  if (std::memcmp(header->magic, WORD_SHARDS_MAGIC, 4) != 0 || header->version != WORD_SHARDS_VERSION || header->shard_words == 0 || header->shard_words % 64 != 0 ||
+      header->word_count == 0 || header->word_count > (uint64_t)header->shard_count * header->shard_words ||
+      map_size != sizeof(Header) + header->shard_count * shard_bytes(header->shard_words))
+  {
+    munmap(map, map_size);
+    throw std::runtime_error("bad word shards " + shards_path);
+  }
+  shard_words = header->shard_words;
+  shard_count = header->shard_count;
+  word_count = header->word_count;
+  base = static_cast<const char *>(map) + sizeof(Header);
+  // scoring walks the shards front to back
+  posix_madvise(map, map_size, POSIX_MADV_SEQUENTIAL);
+}
+
+WordShards::~WordShards()
+{
+  if (map != MAP_FAILED)
+    munmap(map, map_size);
+}
+
+size_t WordShards::shard_bytes(const size_t words)
+{
+  // first[words], weights[words], vals[5 * words], padded to 8 bytes
+  return (2 * sizeof(double) * words + 5 * words + 7) / 8 * 8;
+}
+
+WordShards::Shard WordShards::get_shard(const size_t i) const
+{
+  const char *p = base + i * shard_bytes(shard_words);
+  Shard shard;
+  shard.first = reinterpret_cast<const double *>(p);
+  shard.weights = shard.first + shard_words;
+  shard.vals = reinterpret_cast<const char *>(shard.weights + shard_words);
+  shard.size = std::min(shard_words, word_count - i * shard_words);
+  return shard;
+}
+
+size_t WordShards::get_shard_count() const
+{
+  return shard_count;
+}
+
+size_t WordShards::get_shard_words() const
+{
+  return shard_words;
+}
+
+size_t WordShards::get_word_count() const
+{
+  return word_count;
+}
+
+const char *WordShards::get_val(const size_t id) const
+{
+  return get_shard(id / shard_words).vals + 5 * (id % shard_words);
+}
+
+double WordShards::get_weight(const size_t id) const
+{
+  return get_shard(id / shard_words).weights[id % shard_words];
+}
+
+size_t WordShards::compile(const std::string &words_path, const std::string &shards_path, const size_t shard_words_)
+{
+  const size_t words_per_shard = std::max<size_t>(64, (shard_words_ + 63) / 64 * 64);
+  std::ifstream in(words_path);
+  if (!in)
+    throw std::runtime_error("cannot open " + words_path);
+  std::vector<char> shard(shard_bytes(words_per_shard));
+  double *first = reinterpret_cast<double *>(shard.data());
+  double *weights = first + words_per_shard;
+  char *vals = reinterpret_cast<char *>(weights + words_per_shard);
+
+  Header header;
+  std::memcpy(header.magic, WORD_SHARDS_MAGIC, 4);
+  header.version = WORD_SHARDS_VERSION;
+  header.shard_words = words_per_shard;
+  header.shard_count = 0;
+  header.word_count = 0;
+
+  // write next to the destination then rename so readers never see half a file
+  const std::string temp_path = shards_path + ".tmp";
+  std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  std::string line;
+  size_t n = 0;
+  auto flush = [&]()
+  {
+    out.write(shard.data(), shard.size());
+    std::fill(shard.begin(), shard.end(), 0);
+    header.shard_count++;
+    n = 0;
+  };
+  while (std::getline(in, line))
+  {
+    if (line.empty())
+      continue;
+    if (line.size() < 7 || line[5] != ' ')
+      throw std::runtime_error("bad line in " + words_path + ": " + line);
+    const double weight = std::stod(line.substr(6));
+    if (!(weight > 0))
+      throw std::runtime_error("word weight must be positive: " + line);
+    first[n] = -weight * std::log2(weight);
+    weights[n] = weight;
+    std::memcpy(vals + 5 * n, line.data(), 5);
+    header.word_count++;
+    if (++n == words_per_shard)
+      flush();
+  }
+  if (n > 0)
+    flush();
+  if (header.word_count == 0)
+    throw std::runtime_error("no words in " + words_path);
+  out.seekp(0);
+  out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  out.close();
+  if (!out)
+    throw std::runtime_error("cannot write " + temp_path);
+  fs::rename(temp_path, shards_path);
+  return header.word_count;
+}
@@ -1,5 +1,37 @@
 #include "main.hpp"
 
+#ifdef _DEBUG
+// count heap allocations so play can check that moves do not allocate
+static std::atomic<long long> heap_allocations(0);
+
+void *operator new(size_t size)
+{
+  heap_allocations++;
+  if (void *p = std::malloc(size))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+  std::free(p);
+}
+#endif
+
+inline long long allocation_count()
+{
+#ifdef _DEBUG
+  return heap_allocations;
+#else
+  return 0;
+#endif
+}
+
 inline void print_arr(const char *label, const char (&arr)[5])
 {
   std::cout << label;
@@ -10,27 +42,87 @@ inline void print_arr(const char *label, const char (&arr)[5])
   std::cout << '\n';
 }
 
+inline void print_ranking(const std::vector<Solver::RankedGuess> &ranking)
+{
+  for (const auto &ranked : ranking)
+  {
+    std::printf("  %s  score %.4f  buckets %d  largest %d  entropy %.3f\n", ranked.word.c_str(), ranked.score,
+                ranked.bucket_count, ranked.largest_bucket, ranked.entropy);
+  }
+}
+
+/*
+A checkpoint that cannot be resumed is moved aside and the run starts fresh.
+*/
+void set_aside_checkpoint(Checkpoint &checkpoint, const std::runtime_error &e)
+{
+  std::cerr << e.what() << ", moved to " << checkpoint.get_path() << ".bad, starting fresh\n";
+  checkpoint.set_aside();
+}
+
+/*
+zero_alloc_moves checks (in debug builds) that no move after the first
+game touches the heap. With a checkpoint, the game count and running
+totals are saved between games and, once main has loaded it, a restarted
+run plays the rest.
+*/
 template <typename T>
-void play(Adversary adversary, T solver, const int n)
+void play(Adversary adversary, T &&solver, const int n, const bool zero_alloc_moves = false, Checkpoint *checkpoint = nullptr)
 {
   char word[5], res[5];
   int guess_count = 0;
   std::vector<long long> stage_runtimes{0ll};
   std::vector<std::pair<double, int>> entropy_by_remaining_guess;
-  chrono::_V2::system_clock::time_point start, stop;
+  chrono::_V2::system_clock::time_point start, stop, last_save;
+  long long allocations;
+  int first = 0;
+
+  if (checkpoint && checkpoint->is_loaded())
+  {
+    try
+    {
+      // payload: games played, guess count, stage runtimes, entropy sums and counts
+      std::vector<double> entropy_sums;
+      std::vector<int> entropy_counts;
+      checkpoint->get(first);
+      checkpoint->get(guess_count);
+      checkpoint->get(stage_runtimes);
+      checkpoint->get(entropy_sums);
+      checkpoint->get(entropy_counts);
+      if (first < 0 || first > n || stage_runtimes.empty() || entropy_sums.size() != entropy_counts.size())
+        throw std::runtime_error("checkpoint does not match this run");
+      for (size_t k = 0; k < entropy_sums.size(); k++)
+      {
+        entropy_by_remaining_guess.push_back(std::make_pair(entropy_sums[k], entropy_counts[k]));
+      }
+      std::printf("resuming after %d games\n", first);
+    }
+    catch (const std::runtime_error &e)
+    {
+      set_aside_checkpoint(*checkpoint, e);
+      first = 0;
+      guess_count = 0;
+      stage_runtimes.assign(1, 0ll);
+      entropy_by_remaining_guess.clear();
+    }
+  }
+  last_save = chrono::high_resolution_clock::now();
 
   try
   {
-    for (int i = 0; i < n; i++)
+    for (int i = first; i < n; i++)
     {
       std::vector<double> stage_entropy;
       int j = 0;
 
       stage_entropy.push_back(solver.get_entropy());
 
+      allocations = allocation_count();
       start = chrono::high_resolution_clock::now();
       solver.make_guess(word);
       stop = chrono::high_resolution_clock::now();
+      if (zero_alloc_moves && i > first && allocation_count() != allocations)
+        throw std::runtime_error("first guess allocated");
 
       stage_runtimes[0] += chrono::duration_cast<chrono::milliseconds>(stop - start).count();
 
@@ -41,9 +133,12 @@ void play(Adversary adversary, T solver, const int n)
         j++;
         stage_entropy.push_back(solver.get_entropy());
 
+        allocations = allocation_count();
         start = chrono::high_resolution_clock::now();
         solver.make_guess(word, res);
         stop = chrono::high_resolution_clock::now();
+        if (zero_alloc_moves && i > first && allocation_count() != allocations)
+          throw std::runtime_error("guess allocated");
 
         if (j >= (int)stage_runtimes.size())
         {
@@ -74,6 +169,25 @@ void play(Adversary adversary, T solver, const int n)
       guess_count += j + 1;
       adversary.new_word();
       solver.reset();
+
+      if (checkpoint && chrono::duration_cast<chrono::milliseconds>(chrono::high_resolution_clock::now() - last_save).count() >= CHECKPOINT_INTERVAL_MS)
+      {
+        std::vector<double> entropy_sums;
+        std::vector<int> entropy_counts;
+        for (const auto &entry : entropy_by_remaining_guess)
+        {
+          entropy_sums.push_back(entry.first);
+          entropy_counts.push_back(entry.second);
+        }
+        checkpoint->clear();
+        checkpoint->put(i + 1);
+        checkpoint->put(guess_count);
+        checkpoint->put(stage_runtimes);
+        checkpoint->put(entropy_sums);
+        checkpoint->put(entropy_counts);
+        checkpoint->save();
+        last_save = chrono::high_resolution_clock::now();
+      }
     }
   }
   catch (const std::exception &e)
@@ -85,6 +199,9 @@ void play(Adversary adversary, T solver, const int n)
     std::exit(EXIT_FAILURE);
   }
 
+  if (checkpoint)
+    checkpoint->remove();
+
   std::printf("mean guess count: %.3f\n", (double)guess_count / n);
   std::cout << "guess mean runtimes (ms)\n";
   for (size_t i = 0; i < stage_runtimes.size(); i++)
@@ -99,7 +216,7 @@ void play(Adversary adversary, T solver, const int n)
 }
 
 template <typename T>
-void play(Adversary adversary, T solver)
+void play(Adversary adversary, T &&solver)
 {
   char word[5], res[5];
   int num_guesses = 1;
@@ -134,29 +251,486 @@ void play(Adversary adversary, T solver)
   }
 }
 
+void print_results(const std::vector<int> &results)
+{
+  std::vector<int> distribution;
+  long long guess_count = 0;
+  for (const int count : results)
+  {
+    if (count >= (int)distribution.size())
+      distribution.resize(count + 1, 0);
+    distribution[count]++;
+    guess_count += count;
+  }
+  std::printf("targets: %lu\n", results.size());
+  std::printf("mean guess count: %.3f\n", (double)guess_count / results.size());
+  std::cout << "guess count distribution\n";
+  for (size_t i = 1; i < distribution.size(); i++)
+  {
+    std::printf("%lu: %d\n", i, distribution[i]);
+  }
+}
+
+void print_placement(const int workers, const int pinned, const int replicas, PerfCounters &counters)
+{
+  const Topology &topology = Topology::get();
+  std::printf("placement: %d nodes, %d cpus, %d of %d workers pinned, %d node replicas, huge pages %s\n",
+              topology.get_node_count(), topology.get_cpu_count(), pinned, workers, replicas, Topology::get_huge_page_mode().c_str());
+  if (counters.get_available_count() == 0)
+  {
+    std::cout << "placement counters: not available\n";
+    return;
+  }
+  std::vector<long long> values;
+  counters.read(values);
+  for (size_t i = 0; i < values.size(); i++)
+  {
+    if (values[i] < 0)
+      std::printf("%s: not available\n", counters.get_events()[i].name.c_str());
+    else
+      std::printf("%s: %'lld\n", counters.get_events()[i].name.c_str(), values[i]);
+  }
+}
+
+void sweep(const std::string &data_path, const int num_workers, Checkpoint *checkpoint = nullptr)
+{
+  chrono::_V2::system_clock::time_point start, stop;
+  start = chrono::high_resolution_clock::now();
+  Coordinator coordinator(data_path, num_workers, checkpoint);
+  if (coordinator.get_resumed_count() > 0)
+    std::printf("resuming with %lu targets solved\n", coordinator.get_resumed_count());
+  const std::vector<int> results = coordinator.sweep();
+  stop = chrono::high_resolution_clock::now();
+  if (checkpoint)
+    checkpoint->remove();
+
+  print_results(results);
+  std::printf("workers: %d, respawned: %d\n", num_workers, coordinator.get_respawn_count());
+  std::printf("%'ld ms\n", chrono::duration_cast<chrono::milliseconds>(stop - start).count());
+}
+
+/*
+Reads one command per line from stdin so a running solver can follow
+dictionary changes:
+  add <word> <weight>, remove <word>, weight <word> <weight>,
+  guess, result <5 of G Y B>, reset, quit
+*/
+void serve(const std::string &data_path)
+{
+  SolverParallel solver(data_path);
+  solver.enable_pattern_cache(PATTERN_CACHE_BUDGET_BYTES);
+  solver.enable_ranking(RANKED_GUESSES);
+  char word[5], res[5];
+  std::string line, command, val;
+  double weight;
+  chrono::_V2::system_clock::time_point start, stop;
+  while (std::getline(std::cin, line))
+  {
+    std::istringstream in(line);
+    if (!(in >> command))
+      continue;
+    if (command == "quit")
+      break;
+    try
+    {
+      start = chrono::high_resolution_clock::now();
+      if (command == "add" && in >> val >> weight)
+        solver.add_word(val, weight);
+      else if (command == "remove" && in >> val)
+        solver.remove_word(val);
+      else if (command == "weight" && in >> val >> weight)
+        solver.set_word_weight(val, weight);
+      else if (command == "reset")
+        solver.reset();
+      else if (command == "guess")
+      {
+        solver.make_guess(word);
+        print_arr("word: ", word);
+        print_ranking(solver.get_ranking());
+      }
+      else if (command == "result" && in >> val && val.size() == 5 && val.find_first_not_of("GYB") == std::string::npos)
+      {
+        std::copy(val.begin(), val.end(), res);
+        solver.make_guess(word, res);
+        print_arr("word: ", word);
+        print_ranking(solver.get_ranking());
+      }
+      else
+        throw std::runtime_error("bad command: " + line);
+      stop = chrono::high_resolution_clock::now();
+      std::printf("ok %'ld ms\n", chrono::duration_cast<chrono::milliseconds>(stop - start).count());
+    }
+    catch (const std::exception &e)
+    {
+      std::cout << "error: " << e.what() << '\n';
+    }
+    std::cout.flush();
+  }
+}
+
+/*
+Assists a real game. Each line is a guess and the result it got, as
+"tares BYBBG", or one of undo, new, quit. Suggestions come from the
+opening book or from states already scored this session when possible,
+and undo restores the candidates saved before the move.
+*/
+void assist(const std::string &data_path, const std::string &book_path)
+{
+  SolverParallel solver(data_path);
+  solver.enable_pattern_cache(PATTERN_CACHE_BUDGET_BYTES);
+  solver.enable_ranking(RANKED_GUESSES);
+  OpeningBook book, seen;
+  try
+  {
+    OpeningBook loaded(book_path);
+    if (loaded.get_key() == OpeningBook::make_key(data_path))
+      book = std::move(loaded);
+    else
+      std::cout << "opening book is out of date, rebuild it with mode b\n";
+  }
+  catch (const std::exception &e)
+  {
+    std::cout << "no opening book: " << e.what() << '\n';
+  }
+  std::printf("opening book: %lu states\n", book.get_entry_count());
+
+  std::string history, line, guess, result;
+  std::vector<std::string> histories;
+  std::vector<Solver::Snapshot> undo;
+  chrono::_V2::system_clock::time_point start;
+  const auto suggest = [&]()
+  {
+    const char *source = "book";
+    const std::vector<Solver::RankedGuess> *ranking = book.find(history);
+    if (!ranking)
+    {
+      source = "cache";
+      ranking = seen.find(history);
+    }
+    if (!ranking)
+    {
+      char word[5];
+      source = "scored";
+      solver.make_guess(word);
+      seen.insert(history, solver.get_ranking());
+      ranking = seen.find(history);
+    }
+    const double ms = chrono::duration<double, std::milli>(chrono::high_resolution_clock::now() - start).count();
+    std::printf("suggest: %s (%s, %.3f ms)\n", ranking->front().word.c_str(), source, ms);
+    print_ranking(*ranking);
+  };
+
+  start = chrono::high_resolution_clock::now();
+  suggest();
+  std::cout.flush();
+  while (std::getline(std::cin, line))
+  {
+    std::istringstream in(line);
+    if (!(in >> guess))
+      continue;
+    if (guess == "quit")
+      break;
+    try
+    {
+      start = chrono::high_resolution_clock::now();
+      if (guess == "new")
+      {
+        solver.reset();
+        history.clear();
+        histories.clear();
+        undo.clear();
+      }
+      else if (guess == "undo")
+      {
+        if (undo.empty())
+          throw std::runtime_error("nothing to undo");
+        solver.restore_snapshot(undo.back());
+        undo.pop_back();
+        history = histories.back();
+        histories.pop_back();
+      }
+      else if (in >> result && result.size() == 5)
+      {
+        char res[5];
+        std::copy(result.begin(), result.end(), res);
+        if (result == "GGGGG")
+        {
+          std::printf("solved in %lu guesses\n", undo.size() + 1);
+          solver.reset();
+          history.clear();
+          histories.clear();
+          undo.clear();
+        }
+        else
+        {
+          undo.emplace_back();
+          solver.save_snapshot(undo.back());
+          try
+          {
+            solver.apply_result(guess, res);
+          }
+          catch (const std::exception &)
+          {
+            undo.pop_back();
+            throw;
+          }
+          histories.push_back(history);
+          history = OpeningBook::extend(history, guess, result);
+        }
+      }
+      else
+        throw std::runtime_error("bad command: " + line);
+      suggest();
+    }
+    catch (const std::exception &e)
+    {
+      std::cout << "error: " << e.what() << '\n';
+    }
+    std::cout.flush();
+  }
+}
+
+void print_sample(const SolverBenchmark::Sample &sample, const std::vector<PerfCounters::Event> &events)
+{
+  std::printf("%s: %'lld calls, %'lld pairs, %.3f ms", sample.name.c_str(), sample.calls, sample.pairs, sample.ms);
+  if (sample.pairs > 0)
+    std::printf(", %.3f ns/pair", sample.ms * 1e6 / sample.pairs);
+  std::cout << '\n';
+  long long cycles = -1, instructions = -1;
+  for (size_t i = 0; i < events.size(); i++)
+  {
+    if (sample.counts[i] < 0)
+      continue;
+    if (events[i].name == "cycles")
+      cycles = sample.counts[i];
+    if (events[i].name == "instructions")
+      instructions = sample.counts[i];
+    std::printf("  %-22s %'18lld  %'16.1f/call", events[i].name.c_str(), sample.counts[i], (double)sample.counts[i] / sample.calls);
+    if (sample.pairs > 0)
+      std::printf("  %'12.4f/pair", (double)sample.counts[i] / sample.pairs);
+    std::cout << '\n';
+  }
+  if (cycles > 0 && instructions >= 0)
+    std::printf("  instructions per cycle %.3f\n", (double)instructions / cycles);
+}
+
+/*
+Reads hardware counters of this thread around each scoring kernel and
+each move of games against the first target words, so the two can be
+compared per candidate pair.
+*/
+void benchmark(const std::string &data_path, const int games)
+{
+  PerfCounters counters(PerfCounters::profile_events(), false);
+  const std::vector<PerfCounters::Event> &events = counters.get_events();
+  std::vector<long long> probe;
+  counters.read(probe);
+  std::string missing;
+  for (size_t i = 0; i < events.size(); i++)
+  {
+    if (probe[i] < 0)
+      missing += (missing.empty() ? "" : ", ") + events[i].name;
+  }
+  if (!missing.empty())
+    std::printf("counters not available: %s\n", missing.c_str());
+
+  SolverBenchmark solver(data_path);
+  Adversary adversary(data_path);
+  std::vector<std::string> targets = Adversary::load_target_words(data_path);
+  targets.resize(std::min<size_t>(std::max(games, 1), targets.size()));
+
+  std::printf("kernels, %d guesses against every candidate\n", BENCHMARK_GUESSES);
+  for (const auto &sample : solver.run_kernels(counters, adversary, BENCHMARK_GUESSES))
+  {
+    print_sample(sample, events);
+  }
+  std::printf("move stages, %lu games\n", targets.size());
+  for (const auto &sample : solver.run_games(counters, adversary, targets))
+  {
+    print_sample(sample, events);
+  }
+}
+
+void evaluate(const std::string &data_path, const int num_threads)
+{
+  chrono::_V2::system_clock::time_point start, stop;
+  start = chrono::high_resolution_clock::now();
+  Evaluator evaluator(data_path, num_threads);
+  const std::vector<int> results = evaluator.evaluate();
+  stop = chrono::high_resolution_clock::now();
+  print_results(results);
+  std::printf("threads: %d, tree nodes: %lu\n", num_threads, evaluator.get_node_count());
+  std::printf("%'ld ms\n", chrono::duration_cast<chrono::milliseconds>(stop - start).count());
+}
+
 int main(int argc, char const *argv[])
 {
   std::setlocale(LC_NUMERIC, "");
   if (argc < 4)
   {
-    std::cout << "Usage: main <path to data dir> <number of game iterations> <s OR p>\n";
+    std::cout << "Usage: main <path to data dir> <number of game iterations> <s OR p OR a OR l OR t OR r OR h OR v OR d> [checkpoint file]\n"
+              << "       main <path to data dir> <number of workers> c [checkpoint file]\n"
+              << "       main <path to data dir> <number of threads> e\n"
+              << "       main <path to data dir> <number of games> k\n"
+              << "       main <path to data dir> 0 w\n"
+              << "       main <path to data dir> 0 i\n"
+              << "       main <path to data dir> 0 b\n"
+              << "       main <path to data dir> 0 z\n"
+              << "       main <path to data dir> 0 x\n";
     return EXIT_SUCCESS;
   }
 
   int n = std::stoi(argv[2]);
-  if (n <= 1)
+  const std::string tree_path = (fs::path(argv[1]) / fs::path(STRATEGY_TREE_FILE_NAME)).string();
+  const std::string value_table_path = (fs::path(argv[1]) / fs::path(VALUE_TABLE_FILE_NAME)).string();
+  const std::string shards_path = (fs::path(argv[1]) / fs::path(WORD_SHARDS_FILE_NAME)).string();
+  const std::string book_path = (fs::path(argv[1]) / fs::path(OPENING_BOOK_FILE_NAME)).string();
+
+  // a checkpoint only resumes the same mode, game count and input files
+  std::unique_ptr<Checkpoint> checkpoint;
+  if (argc > 4)
   {
-    if (argv[3][0] == 'p')
-      play(Adversary(argv[1]), SolverParallel(argv[1]));
+    std::vector<std::string> inputs{(fs::path(argv[1]) / fs::path(WORD_WEIGHTS_FILE_NAME)).string(),
+                                    (fs::path(argv[1]) / fs::path(TEST_WORDS_FILE_NAME)).string()};
+    if (argv[3][0] == 't')
+      inputs.push_back(tree_path);
+    if (argv[3][0] == 'v')
+      inputs.push_back(value_table_path);
+    if (argv[3][0] == 'd')
+      inputs.push_back(shards_path);
+    checkpoint = std::make_unique<Checkpoint>(argv[4], argv[3][0], Checkpoint::make_key(inputs, argv[3][0] == 'c' ? 0 : n));
+    try
+    {
+      checkpoint->load();
+    }
+    catch (const std::runtime_error &e)
+    {
+      set_aside_checkpoint(*checkpoint, e);
+    }
+  }
+
+  if (argv[3][0] == 'c')
+  {
+    sweep(argv[1], n, checkpoint.get());
+  }
+  else if (argv[3][0] == 'e')
+  {
+    evaluate(argv[1], n);
+  }
+  else if (argv[3][0] == 'w')
+  {
+    serve(argv[1]);
+  }
+  else if (argv[3][0] == 'k')
+  {
+    benchmark(argv[1], n);
+  }
+  else if (argv[3][0] == 'i')
+  {
+    assist(argv[1], book_path);
+  }
+  else if (argv[3][0] == 'b')
+  {
+    std::printf("compiled %lu states into %s\n", OpeningBook::compile(argv[1], book_path, OPENING_BOOK_DEPTH, RANKED_GUESSES), book_path.c_str());
+  }
+  else if (argv[3][0] == 'z')
+  {
+    const std::string words_path = (fs::path(argv[1]) / fs::path(WORD_WEIGHTS_FILE_NAME)).string();
+    std::printf("compiled %lu words into %s\n", WordShards::compile(words_path, shards_path, SHARD_WORDS), shards_path.c_str());
+  }
+  else if (argv[3][0] == 'd')
+  {
+    if (n <= 1)
+      play(Adversary(argv[1]), ShardedSolver(shards_path, SHARD_GUESS_LIMIT));
     else
-      play(Adversary(argv[1]), Solver(argv[1]));
+      play(Adversary(argv[1]), ShardedSolver(shards_path, SHARD_GUESS_LIMIT), n, true, checkpoint.get());
   }
-  else
+  else if (argv[3][0] == 'x')
+  {
+    std::printf("compiled %lu nodes into %s\n", StrategyTree::compile(argv[1], tree_path), tree_path.c_str());
+  }
+  else if (argv[3][0] == 't')
+  {
+    if (n <= 1)
+      play(Adversary(argv[1]), StrategyTree(tree_path));
+    else
+      play(Adversary(argv[1]), StrategyTree(tree_path), n, true, checkpoint.get());
+  }
+  else if (argv[3][0] == 'a')
+  {
+    SolverParallel solver(argv[1]);
+    solver.enable_speculation(SPECULATION_BUDGET_BYTES);
+    if (n <= 1)
+      play(Adversary(argv[1]), solver);
+    else
+      play(Adversary(argv[1]), solver, n, false, checkpoint.get());
+    std::cout << "speculation hits: " << solver.get_speculation_hits() << '\n';
+  }
+  else if (argv[3][0] == 'r')
+  {
+    SolverParallel solver(argv[1]);
+    solver.enable_approx({APPROX_MIN_WORDS, APPROX_INITIAL_SAMPLE, APPROX_FINALISTS, APPROX_Z, (unsigned int)time(NULL)});
+    if (n <= 1)
+      play(Adversary(argv[1]), solver);
+    else
+      play(Adversary(argv[1]), solver, n, false, checkpoint.get());
+  }
+  else if (argv[3][0] == 'h')
+  {
+    SolverParallel solver(argv[1]);
+    solver.enable_incremental(INCREMENTAL_BUDGET_BYTES);
+    if (n <= 1)
+      play(Adversary(argv[1]), solver);
+    else
+      play(Adversary(argv[1]), solver, n, false, checkpoint.get());
+  }
+  else if (argv[3][0] == 'v')
   {
-    if (argv[3][0] == 'p')
-      play(Adversary(argv[1]), SolverParallel(argv[1]), n);
+    SolverParallel solver(argv[1]);
+    solver.load_value_table(value_table_path);
+    if (n <= 1)
+      play(Adversary(argv[1]), solver);
     else
-      play(Adversary(argv[1]), Solver(argv[1]), n);
+      play(Adversary(argv[1]), solver, n, false, checkpoint.get());
+  }
+  else if (argv[3][0] == 'l')
+  {
+    Solver solver(argv[1]);
+    solver.enable_pattern_cache(PATTERN_CACHE_BUDGET_BYTES);
+    if (n <= 1)
+      play(Adversary(argv[1]), solver);
+    else
+      play(Adversary(argv[1]), solver, n, false, checkpoint.get());
+    std::shared_ptr<PatternCache> cache = solver.get_pattern_cache();
+    std::printf("pattern cache: %.3f hit rate, %lld hits, %lld misses, %lld evictions, %lu rows, %'lu bytes\n",
+                cache->get_hit_rate(), cache->get_hits(), cache->get_misses(), cache->get_evictions(),
+                cache->get_row_count(), cache->get_bytes_used());
+  }
+  else if (argv[3][0] == 'p')
+  {
+    // opened before the pool starts so its threads inherit them
+    PerfCounters counters(PerfCounters::placement_events(), true);
+    int pinned, replicas, workers;
+    {
+      SolverParallel solver(argv[1]);
+      if (n <= 1)
+        play(Adversary(argv[1]), solver);
+      else
+        play(Adversary(argv[1]), solver, n, true, checkpoint.get());
+      pinned = solver.get_pinned_count();
+      replicas = solver.get_replica_count();
+      workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // pool threads have exited, so their counts are in
+    print_placement(workers, pinned, replicas, counters);
+  }
+  else if (n <= 1)
+  {
+    play(Adversary(argv[1]), Solver(argv[1]));
+  }
+  else
+  {
+    play(Adversary(argv[1]), Solver(argv[1]), n, true, checkpoint.get());
   }
 
   return EXIT_SUCCESS;
@@ -0,0 +1,93 @@
+/*
+Fits data/value_table.txt from solved games.
+
+Every target in test_words.txt is solved, and each state the solver
+guessed from is recorded with the number of guesses it took from there.
+Later passes solve again with the previous table loaded, so the table
+follows the policy it produces. Every FIT_HOLDOUT_EVERY-th target is held
+out of the fit, so each pass reports the mean guess count both on the
+targets the table was fitted to and on ones it has not seen.
+
+g++ -std=gnu++17 -Ofast -I include -o bin/fit_values src/util/fit_values.cpp src/Solver.cpp src/Adversary.cpp src/PatternCache.cpp src/ValueTable.cpp src/Topology.cpp -pthread
+bin/fit_values data <number of passes>
+*/
+
+#ifndef ADVERSARY_HPP
+#define ADVERSARY_HPP
+#include "Adversary.hpp"
+#endif
+
+#ifndef SOLVER_HPP
+#define SOLVER_HPP
+#include "Solver.hpp"
+#endif
+
+#ifndef STDIO_H
+#define STDIO_H
+#include <stdio.h>
+#endif
+
+/* Counts up to 2^14 and entropy up to 14 bits */
+#define FIT_COUNT_BINS 15
+#define FIT_ENTROPY_BINS 57
+#define FIT_ENTROPY_STEP 0.25
+
+/* Hold out every 5th target from the fit */
+#define FIT_HOLDOUT_EVERY 5
+
+int main(int argc, char const *argv[])
+{
+  if (argc < 2)
+  {
+    std::cout << "Usage: fit_values <path to data dir> [number of passes]\n";
+    return EXIT_SUCCESS;
+  }
+  const fs::path table_path = fs::path(argv[1]) / fs::path(VALUE_TABLE_FILE_NAME);
+  const int passes = argc > 2 ? std::max(1, std::stoi(argv[2])) : 1;
+  const std::vector<std::string> targets = Adversary::load_target_words(argv[1]);
+  Adversary adversary(argv[1]);
+  char word[5], res[5];
+
+  for (int pass = 0; pass < passes; pass++)
+  {
+    Solver solver(argv[1]);
+    if (pass > 0)
+      solver.load_value_table(table_path.string());
+    ValueTable table(FIT_COUNT_BINS, FIT_ENTROPY_BINS, FIT_ENTROPY_STEP);
+    // fitted and held out targets
+    long long guess_count[2] = {0, 0};
+    size_t target_count[2] = {0, 0};
+    for (size_t t = 0; t < targets.size(); t++)
+    {
+      const std::string &target = targets[t];
+      const int held_out = t % FIT_HOLDOUT_EVERY == FIT_HOLDOUT_EVERY - 1;
+      // (count, entropy) of each state a guess was made from
+      std::vector<std::pair<int, double>> states;
+      adversary.set_target_word(target);
+      solver.make_guess(word);
+      states.push_back(std::make_pair(solver.get_word_count(), solver.get_entropy()));
+      adversary.judge(word, res);
+      while (std::count(std::begin(res), std::end(res), 'G') < 5)
+      {
+        if ((int)states.size() >= MAX_GUESSES)
+          throw std::runtime_error("no solution for " + target);
+        solver.make_guess(word, res);
+        states.push_back(std::make_pair(solver.get_word_count(), solver.get_entropy()));
+        adversary.judge(word, res);
+      }
+      for (size_t k = 0; k < states.size() && !held_out; k++)
+      {
+        table.add_sample(states[k].first, states[k].second, states.size() - k);
+      }
+      guess_count[held_out] += states.size();
+      target_count[held_out]++;
+      solver.reset();
+    }
+    table.fit();
+    table.save(table_path.string());
+    // the counts come from the previous pass's table, which never saw the held out targets
+    std::printf("pass %d: mean guess count %.4f fitted, %.4f held out\n", pass + 1,
+                (double)guess_count[0] / std::max<size_t>(1, target_count[0]), (double)guess_count[1] / std::max<size_t>(1, target_count[1]));
+  }
+  return EXIT_SUCCESS;
+}
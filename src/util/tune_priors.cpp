@@ -0,0 +1,200 @@
+/*
+Scores word weight priors over a grid of convert.py's sigmoid parameters.
+
+freq_map.json is read once and the priors for each setting are computed in
+memory, so no word_weights.txt is written. Each thread evaluates settings
+with its own policy walk, and all of them share one pattern row cache,
+since results do not depend on weights.
+
+g++ -std=gnu++17 -Ofast -I include -o bin/tune_priors src/util/tune_priors.cpp src/Solver.cpp src/Adversary.cpp src/PatternCache.cpp src/ValueTable.cpp src/Evaluator.cpp src/Topology.cpp -pthread
+bin/tune_priors data <number of threads> [n_common,...] [width_under_sigmoid,...]
+*/
+
+#ifndef EVALUATOR_HPP
+#define EVALUATOR_HPP
+#include "Evaluator.hpp"
+#endif
+
+#ifndef STDIO_H
+#define STDIO_H
+#include <stdio.h>
+#endif
+
+#ifndef SSTREAM_H
+#define SSTREAM_H
+#include <sstream>
+#endif
+
+#ifndef EXCEPTION_H
+#define EXCEPTION_H
+#include <exception>
+#endif
+
+#ifndef CHRONO_H
+#define CHRONO_H
+#include <chrono>
+namespace chrono = std::chrono;
+#endif
+
+#define FREQ_MAP_FILE_NAME "freq_map.json"
+
+/* Enough for every compressed row of a 13k word dictionary */
+#define TUNE_PATTERN_CACHE_BYTES (256ul << 20)
+
+namespace
+{
+  struct Setting
+  {
+    double n_common;
+    double width_under_sigmoid;
+    double mean;
+    int max_guesses;
+    int over_six;
+    long long ms;
+  };
+
+  // freq_map.json is one flat object of "word": frequency
+  std::vector<std::pair<std::string, double>> read_freq_map(const std::string &path)
+  {
+    std::ifstream file(path);
+    if (!file)
+      throw std::runtime_error("cannot open " + path);
+    const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::vector<std::pair<std::string, double>> freq;
+    size_t pos = 0;
+    while ((pos = text.find('"', pos)) != std::string::npos)
+    {
+      const size_t end = text.find('"', pos + 1);
+      const size_t colon = text.find(':', end);
+      if (end == std::string::npos || colon == std::string::npos)
+        throw std::runtime_error("bad freq map " + path);
+      char *num_end;
+      const double f = std::strtod(text.c_str() + colon + 1, &num_end);
+      if (num_end == text.c_str() + colon + 1)
+        throw std::runtime_error("bad freq map " + path);
+      freq.push_back(std::make_pair(text.substr(pos + 1, end - pos - 1), f));
+      pos = num_end - text.c_str();
+    }
+    return freq;
+  }
+
+  std::vector<double> parse_list(const std::string &arg)
+  {
+    std::vector<double> values;
+    std::istringstream in(arg);
+    std::string item;
+    while (std::getline(in, item, ','))
+    {
+      values.push_back(std::stod(item));
+    }
+    return values;
+  }
+
+  // same as calc_frequency_based_priors in convert.py, with words in ascending frequency
+  void calc_priors(const size_t n, const double n_common, const double width, std::vector<double> &priors)
+  {
+    const double left = width * n_common / n - width;
+    priors.resize(n);
+    for (size_t i = 0; i < n; i++)
+    {
+      priors[i] = 1 / (1 + std::exp(-(left + i * width / (n - 1))));
+    }
+  }
+}
+
+int main(int argc, char const *argv[])
+{
+  if (argc < 3)
+  {
+    std::cout << "Usage: tune_priors <path to data dir> <number of threads> [n_common,...] [width_under_sigmoid,...]\n";
+    return EXIT_SUCCESS;
+  }
+  const std::string data_path = argv[1];
+  const int num_threads = std::max(1, std::stoi(argv[2]));
+  const std::vector<double> n_commons = parse_list(argc > 3 ? argv[3] : "1024,2048,3072,4096");
+  const std::vector<double> widths = parse_list(argc > 4 ? argv[4] : "6,8,10,12");
+
+  // stable, so equal frequencies keep the file's order like Python's sort
+  std::vector<std::pair<std::string, double>> freq = read_freq_map((fs::path(data_path) / fs::path(FREQ_MAP_FILE_NAME)).string());
+  std::stable_sort(freq.begin(), freq.end(), [](const std::pair<std::string, double> &a, const std::pair<std::string, double> &b)
+                   { return a.second < b.second; });
+  if (freq.size() < 2)
+    throw std::runtime_error("freq map needs at least 2 words");
+
+  std::vector<Setting> settings;
+  for (const double n_common : n_commons)
+  {
+    for (const double width : widths)
+    {
+      settings.push_back(Setting{n_common, width, 0, 0, 0, 0});
+    }
+  }
+
+  std::shared_ptr<PatternCache> cache = std::make_shared<PatternCache>(TUNE_PATTERN_CACHE_BYTES);
+  std::atomic<size_t> next(0);
+  std::mutex print_mutex;
+  // a worker's exception is kept and rethrown after every thread is joined
+  std::vector<std::exception_ptr> errors(num_threads);
+  auto work = [&](const int t)
+  {
+    try
+    {
+      Evaluator evaluator(data_path, 1);
+      evaluator.enable_pattern_cache(cache);
+      std::vector<double> priors;
+      for (size_t s = next++; s < settings.size(); s = next++)
+      {
+        Setting &setting = settings[s];
+        const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        calc_priors(freq.size(), setting.n_common, setting.width_under_sigmoid, priors);
+        for (size_t i = 0; i < freq.size(); i++)
+        {
+          evaluator.set_word_weight(freq[i].first, priors[i]);
+        }
+        const std::vector<int> results = evaluator.evaluate();
+        long long guess_count = 0;
+        for (const int count : results)
+        {
+          guess_count += count;
+          setting.max_guesses = std::max(setting.max_guesses, count);
+          setting.over_six += count > 6;
+        }
+        setting.mean = (double)guess_count / results.size();
+        setting.ms = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+        std::unique_lock<std::mutex> lock(print_mutex);
+        std::printf("n_common %g, width %g: mean %.4f (%lld ms)\n", setting.n_common, setting.width_under_sigmoid, setting.mean, setting.ms);
+        std::fflush(stdout);
+      }
+    }
+    catch (...)
+    {
+      errors[t] = std::current_exception();
+      next = settings.size();
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 1; i < num_threads; i++)
+  {
+    threads.emplace_back(work, i);
+  }
+  work(0);
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
+  for (const auto &error : errors)
+  {
+    if (error)
+      std::rethrow_exception(error);
+  }
+
+  std::sort(settings.begin(), settings.end(), [](const Setting &a, const Setting &b)
+            { return a.mean < b.mean; });
+  std::printf("%10s %8s %8s %5s %5s\n", "n_common", "width", "mean", "max", ">6");
+  for (const auto &setting : settings)
+  {
+    std::printf("%10g %8g %8.4f %5d %5d\n", setting.n_common, setting.width_under_sigmoid, setting.mean, setting.max_guesses, setting.over_six);
+  }
+  std::printf("pattern cache: %.3f hit rate, %lu rows, %lu bytes\n", cache->get_hit_rate(), cache->get_row_count(), cache->get_bytes_used());
+  return EXIT_SUCCESS;
+}